@@ -0,0 +1,120 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    classificationCache.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the cache in front of the classifier.
+			Consecutive frames of the same object give nearly the
+			same features, so the kNN result is kept for features
+			that fall in the same cell of a grid (in std devs of
+			the db) and reused instead of searching the db again.
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+#include "classificationCache.h"
+
+ClassificationCache::ClassificationCache(int capacity, double gridStep)
+	: capacity(std::max(capacity, 0)), gridStep(gridStep > 0 ? gridStep : 0.05), valid(false),
+	dbVersion(0), dbAddress(nullptr), cachedK(0), cachedStdMultiplier(0),
+	numHits(0), numMisses(0), numInvalidations(0)
+{
+}
+
+// FNV-1a over the cell coordinates
+size_t ClassificationCache::KeyHash::operator()(const Key& key) const {
+	uint64_t hash = 14695981039346656037ULL;
+	for (int32_t cell : key) {
+		hash ^= static_cast<uint32_t>(cell);
+		hash *= 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+void ClassificationCache::reset(const FeatureDB& db, int k, float std_multiplier) {
+	if (valid) {
+		numInvalidations++;
+	}
+	entries.clear();
+	index.clear();
+	valid = true;
+	dbVersion = db.version;
+	dbAddress = &db;
+	cachedK = k;
+	cachedStdMultiplier = std_multiplier;
+	// same scale as the classifier, a feature that never
+	// changes gets 1 so it does not divide by 0
+	getStandardDeviation(db.allFeatures, stdDeviations);
+	for (double& stdDev : stdDeviations) {
+		if (!(stdDev > 0)) {
+			stdDev = 1;
+		}
+	}
+}
+
+int ClassificationCache::classify(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel,
+	double& outputDistance)
+{
+	if (capacity == 0) {
+		return kNearestNeigborDistance(targetFeatures, db, k, std_multiplier, outputLabel, outputDistance);
+	}
+	if (!valid || db.version != dbVersion || &db != dbAddress || k != cachedK || std_multiplier != cachedStdMultiplier) {
+		reset(db, k, std_multiplier);
+	}
+
+	// grid cell of the features, in std devs
+	Key key;
+	for (int i = 0; i < NUM_SHAPE_FEATURES; i++) {
+		double cell = std::floor(targetFeatures[i] / stdDeviations[i] / gridStep);
+		// out of range (or nan) features all share the edge cells
+		cell = cell > INT32_MAX ? INT32_MAX : (cell >= INT32_MIN ? cell : INT32_MIN);
+		key[i] = static_cast<int32_t>(cell);
+	}
+
+	auto found = index.find(key);
+	if (found != index.end()) {
+		// hit, move to the front
+		entries.splice(entries.begin(), entries, found->second);
+		const ClassificationResult& result = found->second->second;
+		outputLabel = result.label;
+		outputDistance = result.distance;
+		numHits++;
+		return result.nearestIndex;
+	}
+
+	numMisses++;
+	ClassificationResult result;
+	result.nearestIndex = kNearestNeigborDistance(targetFeatures, db, k, std_multiplier, result.label, result.distance);
+	outputLabel = result.label;
+	outputDistance = result.distance;
+
+	// reuse the least recently used entry once full
+	if (static_cast<int>(entries.size()) >= capacity) {
+		index.erase(entries.back().first);
+		entries.back().first = key;
+		entries.back().second = result;
+		entries.splice(entries.begin(), entries, std::prev(entries.end()));
+	}
+	else {
+		entries.emplace_front(key, result);
+	}
+	index[key] = entries.begin();
+	return result.nearestIndex;
+}
+
+void ClassificationCache::printSummary() const {
+	if (capacity == 0) {
+		return;
+	}
+	printf("classification cache: %lld hits / %lld lookups (%.1f%%), %lld invalidations\n",
+		numHits, lookups(), lookups() > 0 ? 100.0 * numHits / lookups() : 0.0, numInvalidations);
+}
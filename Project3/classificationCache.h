@@ -0,0 +1,85 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    classificationCache.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the cache in front of the classifier.
+			Consecutive frames of the same object give nearly the
+			same features, so the kNN result is kept for features
+			that fall in the same cell of a grid (in std devs of
+			the db) and reused instead of searching the db again.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "featureRecord.h"
+#include "featureExtraction.h"
+
+// kNN result as cached
+struct ClassificationResult {
+	std::string label;
+	double distance;  // distance to the label in std devs
+	int nearestIndex; // row of the nearest neighbor, -1 for "Unkown"
+};
+
+// Least recently used cache of kNN results.
+// Features are divided by the std dev of each feature in the db and
+// rounded down to multiples of gridStep, features in the same cell
+// share a result. The whole cache is dropped when the db version,
+// k or std_multiplier changes.
+class ClassificationCache {
+public:
+	// capacity 0 turns the cache off, every call runs the classifier
+	explicit ClassificationCache(int capacity = 256, double gridStep = 0.05);
+
+	// kNearestNeigborDistance through the cache, same outputs
+	int classify(const FeatureVector& targetFeatures,
+		const FeatureDB& db,
+		int k,
+		float std_multiplier,
+		std::string& outputLabel,
+		double& outputDistance);
+
+	long long hits() const { return numHits; }
+	long long lookups() const { return numHits + numMisses; }
+	long long invalidations() const { return numInvalidations; }
+
+	// Prints hits, lookups, hit rate and invalidations
+	void printSummary() const;
+
+private:
+	typedef std::array<int32_t, NUM_SHAPE_FEATURES> Key;
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+	typedef std::pair<Key, ClassificationResult> Entry;
+
+	// drops every entry and takes the scale of db
+	void reset(const FeatureDB& db, int k, float std_multiplier);
+
+	int capacity;
+	double gridStep;
+	// most recently used first
+	std::list<Entry> entries;
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+	// what the cached results were computed with
+	bool valid;
+	uint64_t dbVersion;
+	const FeatureDB* dbAddress;
+	int cachedK;
+	float cachedStdMultiplier;
+	FeatureVector stdDeviations;
+
+	long long numHits;
+	long long numMisses;
+	long long numInvalidations;
+};
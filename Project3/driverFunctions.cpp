@@ -23,121 +23,268 @@
 #include <cstdlib>
 #include <stack>
 #include <queue>
+#include <set>
 #include <math.h>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "imageProcessing.h"
+#include "driverFunctions.h"
 #include "featureExtraction.h"
+#include "trainingCapture.h"
+#include "threadPool.h"
+#include "frameSource.h"
+#include "sharedMemory.h"
+#include "frameScheduler.h"
+#include "classificationCache.h"
+#include "sharedFeatureDB.h"
+
+// Draws the selected view of a segmented frame and its label
+// view: 0 raw, 1 largest region with axis and bounding box,
+//       2 threshold, 3 cleaned threshold, 4 region map
+static void renderDisplayFrame(const cv::Mat& frame, const SegmentationResult& segmentation,
+    int view, const std::string& label, cv::Mat& displayFrame)
+{
+    switch (view) {
+        case 0: // raw
+            frame.copyTo(displayFrame);
+            break;
+        case 1: { // final
+            cv::Mat largestRegionImage;
+            decodeRLE(segmentation.largestRegion, largestRegionImage);
+            drawAxisLinesAndBoundingBox(largestRegionImage, displayFrame);
+            break;
+        }
+        case 2: // threshold
+            decodeRLE(segmentation.thresholdMask, displayFrame);
+            break;
+        case 3: // cleaned threshold
+            decodeRLE(segmentation.cleanedMask, displayFrame);
+            break;
+        case 4: // region map
+            // Create color image for visualization
+            cv::Mat cleanedImg, regionImage;
+            decodeRLE(segmentation.cleanedMask, cleanedImg);
+            cv::cvtColor(cleanedImg, regionImage, cv::COLOR_GRAY2BGR);  
+            // Generate a random color for each region
+            std::vector<cv::Vec3b> colors(segmentation.numOfRegions + 1, cv::Vec3b(255, 255, 255));
+            for (int i = 1; i < segmentation.numOfRegions; i++)
+            {
+                colors[i] = cv::Vec3b(rand() & 255, rand() & 255, rand() & 255);
+            }
+            // Apply the color to the runs of each region in the color image
+            for (const Run& run : segmentation.cleanedMask.runs) {
+                cv::Vec3b* rptr = regionImage.ptr<cv::Vec3b>(run.row);
+                std::fill(rptr + run.start, rptr + run.end, colors[run.label]);
+            }
+            regionImage.copyTo(displayFrame);
+            break;
+    }
+    // draw label    
+    cv::putText(displayFrame, label, cv::Point(30, 30),
+        cv::FONT_HERSHEY_DUPLEX, 1.1,
+        cv::Scalar(255, 255, 255));
+}
 
  // executes the pipeline for live video feed
 int executeVideoFeed() {
-    cv::VideoCapture* capdev;
     // open the video device
-    capdev = new cv::VideoCapture(0);
-    if (!capdev->isOpened()) {
+    CameraFrameSource camera(0);
+    if (!camera.isOpened()) {
         printf("Unable to open video device\n");
         return(-1);
     }
-    // get some properties of the image
-    cv::Size refS((int)capdev->get(cv::CAP_PROP_FRAME_WIDTH),
-        (int)capdev->get(cv::CAP_PROP_FRAME_HEIGHT));
+    return executeVideoFeed(camera, VideoFeedOptions());
+}
 
-    cv::namedWindow("Video", 1); // create a window
+// executes the pipeline on frames from any frame source
+int executeVideoFeed(FrameSource& frameSource, const VideoFeedOptions& options) {
+    if (!frameSource.isOpened()) {
+        printf("Unable to open %s\n", frameSource.name().c_str());
+        return(-1);
+    }
+    printf("Reading frames from %s\n", frameSource.name().c_str());
+
+    if (!options.headless) {
+        cv::namedWindow("Video", 1); // create a window
+    }
+
+    // throughput and per frame latency (frame read to result ready)
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point loopStart = Clock::now();
+    int numFrames = 0;
+    double totalLatencyMs = 0, maxLatencyMs = 0;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // steps quality down when frames go over budget
+    FrameScheduler scheduler(options.frameBudgetMs);
 
     // init variables for loop
     cv::Mat frame;
     cv::Mat displayFrame;
     int modifierFlag = 0;
-    std::string label;
+    SegmentationOptions segmentationOptions = options.segmentation;
+
+    // load db once, new samples are added to it as they are labelled.
+    // A db.txt of another schema is neither used nor added to.
+    FeatureDB featureDB;
+    readDBFile("db.txt", featureDB);
+    bool canCapture = checkDBFileSchema("db.txt") == 1;
+    if (!canCapture) {
+        printf("db.txt holds another feature schema, samples can not be captured (move it away to start a new db)\n");
+    }
+    TrainingCapture trainingCapture;
+    DBWriter dbWriter("db.txt");
+    std::vector<TrainingSample> labelledSamples;
+
+    // skips the kNN search for features seen on recent frames
+    ClassificationCache classificationCache(options.classificationCacheSize, options.classificationCacheGrid);
+
+    // last classification, reused on frames that are not classified
+    std::string nnLabel;
+    double nnDistance = 0;
+    int nnIndex = -1;
+    int framesSinceClassified = 0;
 
     // video loop
     for (;;) {
-        *capdev >> frame; // get a new frame from the camera, treat as a stream
+        if (options.maxFrames > 0 && numFrames >= options.maxFrames) {
+            break;
+        }
+        // get a new frame, treat as a stream
+        if (!frameSource.read(frame)) {
+            break;
+        }
+        Clock::time_point frameStart = Clock::now();
+        long long frameTimestampNs;
+        if (!frameSource.frameTimestamp(frameTimestampNs)) {
+            frameTimestampNs = wallClockNs();
+        }
+        // results must name the producer's frame, frames may be dropped
+        unsigned long long frameSequence;
+        if (!frameSource.frameSequence(frameSequence)) {
+            frameSequence = numFrames;
+        }
+
+        // settings of the current quality level
+        const QualityLevel& quality = scheduler.qualityLevel();
+        segmentationOptions.morphologyPasses = quality.morphologyPasses;
+        segmentationOptions.scale = quality.segmentationScale;
 
         // Process Image:
-        // blur
-        cv::Mat blurTarget;
-        cv::GaussianBlur(frame, blurTarget, cv::Size(5, 5), 6, 6);
-
-        // grey
-        cv::Mat grayscale;
-        cv::cvtColor(blurTarget, grayscale, cv::COLOR_BGR2GRAY);
-       
-        // threshold
-        cv::Mat otsuThresholdImg, finalThresholdImg;
-        cv::threshold(grayscale, otsuThresholdImg, 0, 255, cv::THRESH_OTSU);
-        cv::bitwise_not(otsuThresholdImg, finalThresholdImg);
-        //cv::adaptiveThreshold(grayscale, finalThresholdImg, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY_INV, 40, 6);
-        
-        // clean up
-        cv::Mat erodeImg, dilateImg, cleanedImg;
-        //cv::erode(finalThresholdImg, erodeImg, cv::Mat(), cv::Point(-1, -1), 1);
-        cv::dilate(finalThresholdImg, dilateImg, cv::Mat(), cv::Point(-1, -1), 4);
-        cv::erode(dilateImg, erodeImg, cv::Mat(), cv::Point(-1, -1), 2);
-        cv::dilate(erodeImg, dilateImg, cv::Mat(), cv::Point(-1, -1), 4);
-        cv::erode(dilateImg, cleanedImg, cv::Mat(), cv::Point(-1, -1), 6);
-        
-        // create labelMap
-        cv::Mat labelMap;
-        int numOfRegions = regionGrowing(cleanedImg, labelMap, 255);
-       
-        // retain only largest region in image
-        cv::Mat largestRegionImage;
-        int largestRegionId = filterOnlylargestRegion(cleanedImg, labelMap, largestRegionImage, numOfRegions);
+        // blur, grey, threshold, clean up, label regions
+        // and retain only largest region in image
+        Clock::time_point stageStart = Clock::now();
+        SegmentationResult segmentation;
+        segmentFrame(frame, segmentation, segmentationOptions);
+        scheduler.recordStage(STAGE_SEGMENT, elapsedMs(stageStart));
         
         // compute features
-        std::vector<double> featureVector;
-        getFeatures(largestRegionImage, featureVector);
-
-        // find nearest neighbor label
-        std::string nnLabel;
-        //int nnIndex = nearestNeigborDistance(featureVector, "db.txt", nnLabel);
-        // using k-nearest neighbor, k =2
-        int nnIndex = kNearestNeigborDistance(featureVector, "db.txt", 2, 1,  nnLabel);
+        stageStart = Clock::now();
+        FeatureVector featureVector;
+        getFeatures(segmentation.largestRegion, featureVector);
+        scheduler.recordStage(STAGE_FEATURES, elapsedMs(stageStart));
+
+        // add samples labelled on the console thread since last frame
+        labelledSamples.clear();
+        trainingCapture.collectLabelled(labelledSamples);
+        for (const TrainingSample& sample : labelledSamples) {
+            addFeatureRow(featureDB, sample.features, sample.label);
+            dbWriter.enqueue(sample.features, sample.label);
+        }
+
+        // find nearest neighbor label, on every Nth frame
+        // at the lower quality levels
+        if (framesSinceClassified + 1 >= quality.classifyEvery || !labelledSamples.empty()) {
+            stageStart = Clock::now();
+            //nnIndex = nearestNeigborDistance(featureVector, featureDB, nnLabel);
+            // using k-nearest neighbor, k =2
+            nnIndex = classificationCache.classify(featureVector, featureDB, options.knnK, options.stdMultiplier, nnLabel, nnDistance);
+            scheduler.recordStage(STAGE_CLASSIFY, elapsedMs(stageStart));
+            framesSinceClassified = 0;
+        }
+        else {
+            framesSinceClassified++;
+        }
+
+        // publish result to other processes
+        if (options.resultPublisher != nullptr) {
+            ResultRecord record = ResultRecord();
+            record.frameSequence = frameSequence;
+            record.frameTimestampNs = frameTimestampNs;
+            record.distance = (float)nnDistance;
+            cv::Point2d centroid;
+            double axisAngle = 0;
+            cv::RotatedRect boundingBox;
+            if (getAxisAndBoundingBox(segmentation.largestRegion, centroid, axisAngle, boundingBox)) {
+                record.boxCenterX = boundingBox.center.x;
+                record.boxCenterY = boundingBox.center.y;
+                record.boxWidth = boundingBox.size.width;
+                record.boxHeight = boundingBox.size.height;
+                record.boxAngle = boundingBox.angle;
+                record.axisAngle = (float)axisAngle;
+            }
+            record.qualityLevel = scheduler.levelIndex();
+            record.resultTimestampNs = wallClockNs();
+            bool known = nnIndex >= 0 && !featureDB.labels.empty();
+            options.resultPublisher->publish(record, nnLabel, known);
+        }
  
-        // whether to display raw image or processed image
-        switch (modifierFlag) {
-            case 0: // raw
-                frame.copyTo(displayFrame);
-                break;
-            case 1: // final
-                largestRegionImage.copyTo(displayFrame);
-                drawAxisLinesAndBoundingBox(largestRegionImage, displayFrame);
-                break;
-            case 2: // threshold
-                finalThresholdImg.copyTo(displayFrame);
-                break;
-            case 3: // cleaned threshold
-                cleanedImg.copyTo(displayFrame);
-                break;
-            case 4: // region map
-                // Create color image for visualization
-                cv::Mat regionImage;
-                cv::cvtColor(cleanedImg, regionImage, cv::COLOR_GRAY2BGR);  
-                // Loop over regions and color each one differently
-                for (int i = 1; i < numOfRegions; i++)
-                {
-                    // Create a mask for this region
-                    // a mask is an image where it is 0 when false, 255 when true
-                    // in this case true when at i (label id) for labelImg
-                    cv::Mat mask = labelMap == i;
-
-                    // Generate a random color for this region
-                    cv::Scalar color(rand() & 255, rand() & 255, rand() & 255);
-
-                    // Apply the color to the region in the color image
-                    regionImage.setTo(color, mask);
-                }
-                regionImage.copyTo(displayFrame);
-                break;
-        }
-        // draw label    
-        cv::putText(displayFrame, nnLabel, cv::Point(30, 30),
-            cv::FONT_HERSHEY_DUPLEX, 1.1,
-            cv::Scalar(255, 255, 255));
-                
-        // show display frame
-        cv::imshow("Video", displayFrame);
+        // whether to display raw image or processed image,
+        // only the raw image when the overlay is skipped
+        stageStart = Clock::now();
+        renderDisplayFrame(frame, segmentation, quality.drawOverlay ? modifierFlag : 0, nnLabel, displayFrame);
+
+        // draw quality level when the scheduler is on
+        if (scheduler.budget() > 0) {
+            std::string levelText = "Q" + std::to_string(scheduler.levelIndex()) + " " + quality.name;
+            cv::putText(displayFrame, levelText, cv::Point(30, displayFrame.rows - 20),
+                cv::FONT_HERSHEY_DUPLEX, 0.6,
+                cv::Scalar(255, 255, 255));
+        }
+
+        // draw the sample waiting for a label in the top right corner
+        cv::Mat thumbnail;
+        if (trainingCapture.pendingThumbnail(thumbnail) && !thumbnail.empty()
+            && thumbnail.cols <= displayFrame.cols && thumbnail.rows <= displayFrame.rows) {
+            cv::Mat thumbnailConverted;
+            if (thumbnail.channels() == displayFrame.channels()) {
+                thumbnailConverted = thumbnail;
+            }
+            else if (displayFrame.channels() == 1) {
+                cv::cvtColor(thumbnail, thumbnailConverted, cv::COLOR_BGR2GRAY);
+            }
+            else {
+                cv::cvtColor(thumbnail, thumbnailConverted, cv::COLOR_GRAY2BGR);
+            }
+            cv::Rect thumbnailArea(displayFrame.cols - thumbnail.cols, 0, thumbnail.cols, thumbnail.rows);
+            thumbnailConverted.copyTo(displayFrame(thumbnailArea));
+            cv::putText(displayFrame, "label?", cv::Point(thumbnailArea.x + 5, thumbnailArea.height - 5),
+                cv::FONT_HERSHEY_DUPLEX, 0.6,
+                cv::Scalar(255, 255, 255));
+        }
+        scheduler.recordStage(STAGE_DISPLAY, elapsedMs(stageStart));
         
+        double latencyMs = elapsedMs(frameStart);
+        totalLatencyMs += latencyMs;
+        maxLatencyMs = std::max(maxLatencyMs, latencyMs);
+        numFrames++;
+        if (scheduler.endFrame(latencyMs)) {
+            printf("Quality level %d (%s), frame time %.1f ms, budget %.1f ms\n", scheduler.levelIndex(),
+                scheduler.qualityLevel().name, scheduler.smoothedFrameTime(), scheduler.budget());
+        }
+        if (options.headless) {
+            continue;
+        }
+
         // show display frame
         cv::imshow("Video", displayFrame);
         
@@ -148,11 +295,14 @@ int executeVideoFeed() {
         else if (key == 'd') {
             modifierFlag = modifierFlag == 1 ? 0 : 1;
         }
+        else if (key == ' ' && !canCapture) {
+            printf("Sample not captured, db.txt holds another feature schema.\n");
+        }
         else if (key == ' ') {
-            std::cout << "Enter label: ";
-            std::getline(std::cin, label);
-            std::cout << "Label: " << label << std::endl;
-            writeFeaturesToFile(featureVector, label, "db.txt");            
+            // snapshot now, the label is typed in the console
+            // while the feed keeps running
+            int sampleId = trainingCapture.submit(featureVector, frame);
+            printf("Captured sample %d.\n", sampleId);
         }
         else if (key == 't') {
             modifierFlag = modifierFlag == 2 ? 0 : 2;
@@ -163,14 +313,552 @@ int executeVideoFeed() {
         else if (key == 'r') {
             modifierFlag = modifierFlag == 4 ? 0 : 4;
         }
+        else if (key == 'a') {
+            segmentationOptions.thresholdMethod = segmentationOptions.thresholdMethod == THRESHOLD_ADAPTIVE
+                ? THRESHOLD_OTSU : THRESHOLD_ADAPTIVE;
+            printf("Threshold: %s\n", thresholdMethodName(segmentationOptions.thresholdMethod));
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - loopStart).count();
+    if (numFrames > 0) {
+        printf("%d frames in %.2f s (%.1f fps), latency mean %.2f ms, max %.2f ms\n",
+            numFrames, seconds, numFrames / seconds, totalLatencyMs / numFrames, maxLatencyMs);
+        scheduler.printSummary();
+        classificationCache.printSummary();
     }
-    delete capdev;
     return(0);
 }
 
+// longest a stream waits for a frame before checking whether it
+// should stop
+static const int STREAM_READ_TIMEOUT_MS = 50;
+
+// One stream of executeMultiStreamFeed. The stream thread owns the
+// pipeline state, the display thread only touches the atomics and
+// what is behind displayMutex.
+struct VideoStream {
+    int id = 0;
+    FrameSource* frameSource = nullptr;
+    std::thread thread;
+
+    // set by the display thread
+    std::atomic<int> view{ 0 };
+    std::atomic<bool> toggleThreshold{ false };
+    std::atomic<bool> captureRequested{ false };
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> finished{ false };
+
+    // last rendered frame, and a requested capture, for the display thread
+    std::mutex displayMutex;
+    cv::Mat displayFrame;
+    long long displaySequence = 0;
+    bool captureReady = false;
+    FeatureVector captureFeatures;
+    cv::Mat captureFrame;
+
+    // written by the stream thread, read after it is joined
+    int numFrames = 0;
+    double totalLatencyMs = 0;
+    double maxLatencyMs = 0;
+    double seconds = 0;
+    std::unique_ptr<FrameScheduler> scheduler;
+    std::unique_ptr<ClassificationCache> classificationCache;
+    // threads of the stream's own pool, the stream thread included
+    int numThreads = 1;
+};
+
+// the per frame pipeline of one stream, classifying against
+// the newest snapshot of the shared db
+static void runVideoStream(VideoStream& stream, const VideoFeedOptions& options, const SharedFeatureDB& sharedDB) {
+    typedef std::chrono::steady_clock Clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    Clock::time_point loopStart = Clock::now();
+    FrameScheduler& scheduler = *stream.scheduler;
+    SegmentationOptions segmentationOptions = options.segmentation;
+
+    // segmentation strips and db scans of this stream run on a pool of
+    // its own, so a large frame on one stream does not hold up the others
+    ThreadPool streamPool(stream.numThreads - 1);
+    ScopedThreadPool useStreamPool(streamPool);
+
+    std::shared_ptr<const FeatureDB> featureDB;
+    sharedDB.refresh(featureDB);
+
+    cv::Mat frame;
+    cv::Mat displayFrame;
+    std::string nnLabel;
+    double nnDistance = 0;
+    int framesSinceClassified = 0;
+    while (!stream.stopping.load()) {
+        if (options.maxFrames > 0 && stream.numFrames >= options.maxFrames) {
+            break;
+        }
+        // wait in short steps, so a stalled producer does not
+        // keep the stream from stopping
+        FrameReadStatus readStatus = stream.frameSource->readFor(frame, STREAM_READ_TIMEOUT_MS);
+        while (readStatus == FRAME_TIMEOUT && !stream.stopping.load()) {
+            readStatus = stream.frameSource->readFor(frame, STREAM_READ_TIMEOUT_MS);
+        }
+        if (readStatus != FRAME_READ) {
+            break;
+        }
+        Clock::time_point frameStart = Clock::now();
+
+        // settings of the current quality level
+        const QualityLevel& quality = scheduler.qualityLevel();
+        segmentationOptions.morphologyPasses = quality.morphologyPasses;
+        segmentationOptions.scale = quality.segmentationScale;
+        if (stream.toggleThreshold.exchange(false)) {
+            segmentationOptions.thresholdMethod = segmentationOptions.thresholdMethod == THRESHOLD_ADAPTIVE
+                ? THRESHOLD_OTSU : THRESHOLD_ADAPTIVE;
+            printf("Stream %d threshold: %s\n", stream.id, thresholdMethodName(segmentationOptions.thresholdMethod));
+        }
+
+        Clock::time_point stageStart = Clock::now();
+        SegmentationResult segmentation;
+        segmentFrame(frame, segmentation, segmentationOptions);
+        scheduler.recordStage(STAGE_SEGMENT, elapsedMs(stageStart));
+
+        stageStart = Clock::now();
+        FeatureVector featureVector;
+        getFeatures(segmentation.largestRegion, featureVector);
+        scheduler.recordStage(STAGE_FEATURES, elapsedMs(stageStart));
+
+        // new samples are picked up here, reclassify straight away
+        bool dbChanged = sharedDB.refresh(featureDB);
+        if (framesSinceClassified + 1 >= quality.classifyEvery || dbChanged) {
+            stageStart = Clock::now();
+            stream.classificationCache->classify(featureVector, *featureDB, options.knnK, options.stdMultiplier, nnLabel, nnDistance);
+            scheduler.recordStage(STAGE_CLASSIFY, elapsedMs(stageStart));
+            framesSinceClassified = 0;
+        }
+        else {
+            framesSinceClassified++;
+        }
+
+        if (!options.headless) {
+            stageStart = Clock::now();
+            renderDisplayFrame(frame, segmentation, quality.drawOverlay ? stream.view.load() : 0, nnLabel, displayFrame);
+            if (scheduler.budget() > 0) {
+                std::string levelText = "Q" + std::to_string(scheduler.levelIndex()) + " " + quality.name;
+                cv::putText(displayFrame, levelText, cv::Point(30, displayFrame.rows - 20),
+                    cv::FONT_HERSHEY_DUPLEX, 0.6,
+                    cv::Scalar(255, 255, 255));
+            }
+            scheduler.recordStage(STAGE_DISPLAY, elapsedMs(stageStart));
+        }
+
+        // hand the frame to the display thread, the capture
+        // keeps its own copy as frame is reused by the source
+        bool capture = stream.captureRequested.exchange(false);
+        {
+            std::lock_guard<std::mutex> lock(stream.displayMutex);
+            if (!options.headless) {
+                cv::swap(displayFrame, stream.displayFrame);
+                stream.displaySequence++;
+            }
+            if (capture) {
+                stream.captureFeatures = featureVector;
+                frame.copyTo(stream.captureFrame);
+                stream.captureReady = true;
+            }
+        }
+
+        double latencyMs = elapsedMs(frameStart);
+        stream.totalLatencyMs += latencyMs;
+        stream.maxLatencyMs = std::max(stream.maxLatencyMs, latencyMs);
+        stream.numFrames++;
+        if (scheduler.endFrame(latencyMs)) {
+            printf("Stream %d quality level %d (%s), frame time %.1f ms, budget %.1f ms\n", stream.id,
+                scheduler.levelIndex(), scheduler.qualityLevel().name, scheduler.smoothedFrameTime(), scheduler.budget());
+        }
+    }
+    stream.seconds = std::chrono::duration<double>(Clock::now() - loopStart).count();
+    stream.finished.store(true);
+}
+
+// executes one pipeline per frame source, each on its own thread
+int executeMultiStreamFeed(const std::vector<FrameSource*>& frameSources, const VideoFeedOptions& options) {
+    for (FrameSource* frameSource : frameSources) {
+        if (!frameSource->isOpened()) {
+            printf("Unable to open %s\n", frameSource->name().c_str());
+            return(-1);
+        }
+    }
+
+    // one db for every stream, new samples are published as a new snapshot
+    FeatureDB initialDB;
+    readDBFile("db.txt", initialDB);
+    bool canCapture = checkDBFileSchema("db.txt") == 1;
+    if (!canCapture) {
+        printf("db.txt holds another feature schema, samples can not be captured (move it away to start a new db)\n");
+    }
+    SharedFeatureDB sharedDB(initialDB);
+    TrainingCapture trainingCapture;
+    DBWriter dbWriter("db.txt");
+    std::vector<TrainingSample> labelledSamples;
+
+    // cores are split evenly between the streams
+    int numCores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int threadsPerStream = std::max(1, numCores / static_cast<int>(frameSources.size()));
+
+    std::vector<std::unique_ptr<VideoStream>> streams;
+    for (int i = 0; i < frameSources.size(); i++) {
+        std::unique_ptr<VideoStream> stream(new VideoStream());
+        stream->id = i + 1;
+        stream->frameSource = frameSources[i];
+        stream->scheduler.reset(new FrameScheduler(options.frameBudgetMs));
+        stream->classificationCache.reset(new ClassificationCache(options.classificationCacheSize, options.classificationCacheGrid));
+        stream->numThreads = threadsPerStream;
+        printf("Stream %d reading frames from %s on %d threads\n", stream->id, frameSources[i]->name().c_str(), threadsPerStream);
+        streams.push_back(std::move(stream));
+    }
+    for (std::unique_ptr<VideoStream>& stream : streams) {
+        VideoStream* streamPtr = stream.get();
+        stream->thread = std::thread([streamPtr, &options, &sharedDB] {
+            runVideoStream(*streamPtr, options, sharedDB);
+        });
+    }
+
+    // display, keys and training on this thread.
+    // Keys act on the selected stream, 1-9 selects one.
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point loopStart = Clock::now();
+    std::vector<long long> shownSequence(streams.size(), 0);
+    int selected = 0;
+    cv::Mat displayFrame;
+    for (;;) {
+        bool allFinished = true;
+        for (int i = 0; i < streams.size(); i++) {
+            VideoStream& stream = *streams[i];
+            allFinished = allFinished && stream.finished.load();
+            bool show = false;
+            bool captured = false;
+            FeatureVector captureFeatures;
+            cv::Mat captureFrame;
+            {
+                std::lock_guard<std::mutex> lock(stream.displayMutex);
+                if (stream.displaySequence != shownSequence[i]) {
+                    shownSequence[i] = stream.displaySequence;
+                    cv::swap(displayFrame, stream.displayFrame);
+                    show = true;
+                }
+                if (stream.captureReady) {
+                    captureFeatures = stream.captureFeatures;
+                    cv::swap(captureFrame, stream.captureFrame);
+                    stream.captureReady = false;
+                    captured = true;
+                }
+            }
+            if (show) {
+                cv::imshow("Video " + std::to_string(stream.id), displayFrame);
+            }
+            if (captured) {
+                int sampleId = trainingCapture.submit(captureFeatures, captureFrame);
+                printf("Captured sample %d from stream %d.\n", sampleId, stream.id);
+            }
+        }
+
+        // publish samples labelled on the console thread to every stream
+        labelledSamples.clear();
+        trainingCapture.collectLabelled(labelledSamples);
+        if (!labelledSamples.empty()) {
+            sharedDB.addSamples(labelledSamples);
+            for (const TrainingSample& sample : labelledSamples) {
+                dbWriter.enqueue(sample.features, sample.label);
+            }
+        }
+
+        if (allFinished) {
+            break;
+        }
+        if (options.headless) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        VideoStream& stream = *streams[selected];
+        char key = cv::waitKey(10);
+        if (key == 'q') {
+            break;
+        }
+        else if (key >= '1' && key <= '9' && key - '1' < (int)streams.size()) {
+            selected = key - '1';
+            printf("Stream %d selected\n", selected + 1);
+        }
+        else if (key == ' ' && !canCapture) {
+            printf("Sample not captured, db.txt holds another feature schema.\n");
+        }
+        else if (key == ' ') {
+            stream.captureRequested.store(true);
+        }
+        else if (key == 'd' || key == 't' || key == 'c' || key == 'r') {
+            int view = key == 'd' ? 1 : (key == 't' ? 2 : (key == 'c' ? 3 : 4));
+            stream.view.store(stream.view.load() == view ? 0 : view);
+        }
+        else if (key == 'a') {
+            stream.toggleThreshold.store(true);
+        }
+    }
+
+    for (std::unique_ptr<VideoStream>& stream : streams) {
+        stream->stopping.store(true);
+    }
+    int totalFrames = 0;
+    for (std::unique_ptr<VideoStream>& stream : streams) {
+        stream->thread.join();
+        totalFrames += stream->numFrames;
+        if (stream->numFrames > 0) {
+            printf("Stream %d: %d frames in %.2f s (%.1f fps), latency mean %.2f ms, max %.2f ms\n", stream->id,
+                stream->numFrames, stream->seconds, stream->numFrames / stream->seconds,
+                stream->totalLatencyMs / stream->numFrames, stream->maxLatencyMs);
+            stream->scheduler->printSummary();
+            stream->classificationCache->printSummary();
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - loopStart).count();
+    printf("%d streams: %d frames in %.2f s (%.1f fps total)\n", (int)streams.size(), totalFrames,
+        seconds, totalFrames / seconds);
+    return(0);
+}
+
+// Times the otsu and adaptive thresholds on frames from a frame source.
+// Every method runs on the same blurred grayscale frame.
+int executeThresholdBenchmark(FrameSource& frameSource, int numFrames, const SegmentationOptions& options) {
+    typedef std::chrono::steady_clock Clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    SegmentationOptions otsuOptions = options;
+    otsuOptions.thresholdMethod = THRESHOLD_OTSU;
+    SegmentationOptions adaptiveOptions = options;
+    adaptiveOptions.thresholdMethod = THRESHOLD_ADAPTIVE;
+    int blockSize = 2 * options.adaptiveRadius + 1;
+
+    cv::Mat frame, blurred, grayscale, adaptiveImage;
+    RLEMask mask;
+    SegmentationResult segmentation;
+    double otsuMs = 0, adaptiveMs = 0, openCvMs = 0, otsuSegmentMs = 0, adaptiveSegmentMs = 0;
+    long long otsuRuns = 0, adaptiveRuns = 0;
+    int frames = 0;
+    while (frames < numFrames && frameSource.read(frame)) {
+        cv::GaussianBlur(frame, blurred, cv::Size(5, 5), 6, 6);
+        cv::cvtColor(blurred, grayscale, cv::COLOR_BGR2GRAY);
+
+        Clock::time_point start = Clock::now();
+        thresholdToRLE(grayscale, otsuThreshold(grayscale), mask);
+        otsuMs += elapsedMs(start);
+        otsuRuns += mask.runs.size();
+
+        start = Clock::now();
+        adaptiveThresholdToRLE(grayscale, options.adaptiveRadius, options.adaptiveOffset, mask);
+        adaptiveMs += elapsedMs(start);
+        adaptiveRuns += mask.runs.size();
+
+        // what the commented out adaptiveThreshold call would cost
+        start = Clock::now();
+        cv::adaptiveThreshold(grayscale, adaptiveImage, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY_INV,
+            blockSize, options.adaptiveOffset);
+        encodeRLE(adaptiveImage, 255, mask);
+        openCvMs += elapsedMs(start);
+
+        start = Clock::now();
+        segmentFrame(frame, segmentation, otsuOptions);
+        otsuSegmentMs += elapsedMs(start);
+
+        start = Clock::now();
+        segmentFrame(frame, segmentation, adaptiveOptions);
+        adaptiveSegmentMs += elapsedMs(start);
+        frames++;
+    }
+    if (frames == 0) {
+        printf("No frames read from %s\n", frameSource.name().c_str());
+        return -1;
+    }
+
+#ifdef __AVX2__
+    const char* kernel = "AVX2";
+#else
+    const char* kernel = "scalar";
+#endif
+    printf("%d frames of %dx%d from %s, adaptive window %d, %s kernel\n",
+        frames, frame.cols, frame.rows, frameSource.name().c_str(), blockSize, kernel);
+    printf("  otsu threshold               %7.3f ms (%lld runs/frame)\n", otsuMs / frames, otsuRuns / frames);
+    printf("  adaptive threshold           %7.3f ms (%lld runs/frame), %.2fx otsu\n",
+        adaptiveMs / frames, adaptiveRuns / frames, adaptiveMs / otsuMs);
+    printf("  cv::adaptiveThreshold + RLE  %7.3f ms\n", openCvMs / frames);
+    printf("  segmentFrame, otsu           %7.3f ms\n", otsuSegmentMs / frames);
+    printf("  segmentFrame, adaptive       %7.3f ms, %.2fx otsu\n",
+        adaptiveSegmentMs / frames, adaptiveSegmentMs / otsuSegmentMs);
+    return 0;
+}
+
+// rows closer than this (scaled euclidean) to an earlier row
+// of the same label are dropped by the bulk training
+static const double BULK_TRAINING_DUPLICATE_DISTANCE = 1e-4;
+
+// returns true if the path is an image the bulk training reads
+static bool isImageFile(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp";
+}
+
+// returns the label of an image laid out as imageDir/<label>/<image>,
+// i.e. the first folder below imageDir (images in subfolders of a label
+// folder get that label). Empty for images directly in imageDir.
+static std::string labelFromPath(const std::string& imageDir, const std::string& path) {
+    if (path.compare(0, imageDir.size(), imageDir) != 0) {
+        return "";
+    }
+    size_t labelStart = path.find_first_not_of("/\\", imageDir.size());
+    if (labelStart == std::string::npos) {
+        return "";
+    }
+    size_t labelEnd = path.find_first_of("/\\", labelStart);
+    if (labelEnd == std::string::npos) {
+        return "";
+    }
+    return path.substr(labelStart, labelEnd - labelStart);
+}
+
+// db rows are separated by whitespace, so a label has to be one word.
+// Replaces whitespace in label with _, returns true if any was replaced.
+static bool replaceLabelWhitespace(std::string& label) {
+    bool replaced = false;
+    for (char& c : label) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            c = '_';
+            replaced = true;
+        }
+    }
+    return replaced;
+}
+
+// rotates (degrees) and scales an image around its center. The canvas
+// grows to fit the result and is padded with the edge pixels, so the
+// object is not cut off and the background stays the same.
+static void rotateAndScale(const cv::Mat& src, cv::Mat& dst, double angle, double scale) {
+    double radians = angle * CV_PI / 180.0;
+    int width = (int)ceil(scale * (fabs(src.cols * cos(radians)) + fabs(src.rows * sin(radians))));
+    int height = (int)ceil(scale * (fabs(src.cols * sin(radians)) + fabs(src.rows * cos(radians))));
+    cv::Mat rotation = cv::getRotationMatrix2D(cv::Point2f(src.cols / 2.0f, src.rows / 2.0f), angle, scale);
+    // move center of the source to center of the new canvas
+    rotation.at<double>(0, 2) += (width - src.cols) / 2.0;
+    rotation.at<double>(1, 2) += (height - src.rows) / 2.0;
+    cv::warpAffine(src, dst, rotation, cv::Size(width, height), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+}
+
+// Builds db rows from a folder of labelled images laid out as
+// imageDir/<label>/<image>. Every image goes through the same
+// segmentation and features as the live feed, on all cores.
+// Returns number of rows written, -1 on error.
+int executeBulkTraining(std::string imageDir, std::string dbFilename, bool augment) {
+    // do not extract features that can not be saved
+    if (!checkDBFileSchema(dbFilename)) {
+        printf("%s holds another feature schema, use a new db file\n", dbFilename.c_str());
+        return -1;
+    }
+
+    // find all images, the label is the folder below imageDir they are in
+    std::vector<cv::String> paths;
+    cv::glob(imageDir, paths, true);
+    std::vector<std::string> imagePaths;
+    for (const cv::String& path : paths) {
+        if (isImageFile(path) && !labelFromPath(imageDir, path).empty()) {
+            imagePaths.push_back(path);
+        }
+    }
+    if (imagePaths.empty()) {
+        printf("No labelled images found in %s\n", imageDir.c_str());
+        return -1;
+    }
+
+    // augmentations applied to every image, the first is the image itself
+    std::vector<std::pair<double, double>> augmentations; // {angle, scale}
+    augmentations.push_back(std::make_pair(0.0, 1.0));
+    if (augment) {
+        const double scales[3] = { 0.8, 1.0, 1.25 };
+        for (double scale : scales) {
+            for (int angle = 0; angle < 360; angle += 45) {
+                if (angle != 0 || scale != 1.0) {
+                    augmentations.push_back(std::make_pair((double)angle, scale));
+                }
+            }
+        }
+    }
+
+    // features of every image, filled in by the pool.
+    // Each image has its own slot so the output order does not
+    // depend on which thread ran it.
+    int numImages = static_cast<int>(imagePaths.size());
+    std::vector<std::vector<FeatureVector>> imageFeatures(numImages);
+    getSharedThreadPool().parallelFor(numImages, [&](int begin, int end, int chunk) {
+        for (int i = begin; i < end; i++) {
+            cv::Mat image = cv::imread(imagePaths[i]);
+            if (image.empty()) {
+                printf("Unable to read %s\n", imagePaths[i].c_str());
+                continue;
+            }
+            for (const std::pair<double, double>& augmentation : augmentations) {
+                cv::Mat augmented;
+                if (augmentation.first == 0 && augmentation.second == 1.0) {
+                    augmented = image;
+                }
+                else {
+                    rotateAndScale(image, augmented, augmentation.first, augmentation.second);
+                }
+                SegmentationResult segmentation;
+                if (segmentFrame(augmented, segmentation) == 0) {
+                    continue; // nothing to learn without a region
+                }
+                FeatureVector featureVector;
+                getFeatures(segmentation.largestRegion, featureVector);
+                imageFeatures[i].push_back(featureVector);
+            }
+        }
+    });
+
+    // collect in image order
+    FeatureDB newRows;
+    std::set<std::string> renamedLabels;
+    for (int i = 0; i < numImages; i++) {
+        std::string label = labelFromPath(imageDir, imagePaths[i]);
+        std::string folder = label;
+        if (replaceLabelWhitespace(label) && renamedLabels.insert(folder).second) {
+            printf("Warning: label folder \"%s\" contains whitespace, saved as \"%s\"\n", folder.c_str(), label.c_str());
+        }
+        for (const FeatureVector& featureVector : imageFeatures[i]) {
+            addFeatureRow(newRows, featureVector, label);
+        }
+    }
+    int numDuplicates = removeNearDuplicates(newRows, BULK_TRAINING_DUPLICATE_DISTANCE);
+
+    // write all rows in one go
+    std::string rows;
+    for (int i = 0; i < newRows.allFeatures.size(); i++) {
+        rows += formatDBRow(newRows.allFeatures[i], newRows.labels[i]);
+    }
+    if (!appendDBRows(dbFilename, rows)) {
+        return -1;
+    }
+
+    printf("Read %d images, saved %d rows to %s (%d near duplicates dropped).\n",
+        numImages, static_cast<int>(newRows.allFeatures.size()), dbFilename.c_str(), numDuplicates);
+    return static_cast<int>(newRows.allFeatures.size());
+}
+
 // Executes the pipeline for a single specified image
 // For development purposes
-int executeSingleImage(cv::Mat& src) {
+int executeSingleImage(cv::Mat& src, const SegmentationOptions& options) {
 
     cv::Mat blurTarget;
     cv::GaussianBlur(src, blurTarget, cv::Size(5, 5), 6, 6);
@@ -183,29 +871,27 @@ int executeSingleImage(cv::Mat& src) {
     cv::namedWindow("Grayscale Image", cv::WINDOW_AUTOSIZE);
     cv::imshow("Grayscale Image", grayscale);
 
-    //cv::Mat simpleThresholdImg;
-    //cv::threshold(grayscale, simpleThresholdImg, 90, 255, cv::THRESH_BINARY_INV);
-    //cv::namedWindow("Smple Thresh Image", cv::WINDOW_AUTOSIZE);
-    //cv::imshow("Smple Thresh Image", simpleThresholdImg);
-
-    //cv::Mat adaptiveThresholdImg;
-    //cv::adaptiveThreshold(grayscale, adaptiveThresholdImg, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY_INV, 45, 6);
-    //cv::namedWindow("Mean Adaptive Thresh Image", cv::WINDOW_AUTOSIZE);
-    //cv::imshow("Mean Adaptive Thresh Image", adaptiveThresholdImg);
-
-    //cv::Mat adaptiveThresholdGaussianImg;
-    //cv::adaptiveThreshold(grayscale, adaptiveThresholdGaussianImg, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY_INV, 45, 6);
-    //cv::namedWindow("Gauss Adaptive Thresh Image", cv::WINDOW_AUTOSIZE);
-    //cv::imshow("Gauss Adaptive Thresh Image", adaptiveThresholdGaussianImg);
-
-    cv::Mat otsuThresholdImg, otsuThresholdImgInv;
-    cv::threshold(grayscale, otsuThresholdImg, 0, 255, cv::THRESH_OTSU);
-    cv::bitwise_not(otsuThresholdImg, otsuThresholdImgInv);
-    cv::namedWindow("Otsu Thresh Image", cv::WINDOW_AUTOSIZE);
-    cv::imshow("Otsu Thresh Image", otsuThresholdImgInv);
+    // otsu or adaptive threshold per options, the clean up below is the
+    // original single image chain rather than the video feed's
+    cv::Mat thresholdImg;
+    std::string thresholdWindow;
+    if (options.thresholdMethod == THRESHOLD_ADAPTIVE) {
+        RLEMask thresholdMask;
+        adaptiveThresholdToRLE(grayscale, options.adaptiveRadius, options.adaptiveOffset, thresholdMask);
+        decodeRLE(thresholdMask, thresholdImg);
+        thresholdWindow = "Adaptive Thresh Image";
+    }
+    else {
+        cv::Mat otsuThresholdImg;
+        cv::threshold(grayscale, otsuThresholdImg, 0, 255, cv::THRESH_OTSU);
+        cv::bitwise_not(otsuThresholdImg, thresholdImg);
+        thresholdWindow = "Otsu Thresh Image";
+    }
+    cv::namedWindow(thresholdWindow, cv::WINDOW_AUTOSIZE);
+    cv::imshow(thresholdWindow, thresholdImg);
 
     cv::Mat erodeImg, dilateImg, cleanedImg;
-    cv::erode(otsuThresholdImgInv, erodeImg, cv::Mat(), cv::Point(-1, -1), 1);
+    cv::erode(thresholdImg, erodeImg, cv::Mat(), cv::Point(-1, -1), 1);
     cv::dilate(erodeImg, dilateImg, cv::Mat(), cv::Point(-1, -1), 2);
     cv::erode(dilateImg, erodeImg, cv::Mat(), cv::Point(-1, -1), 1);
     cv::dilate(erodeImg, dilateImg, cv::Mat(), cv::Point(-1, -1), 2);
@@ -215,7 +901,6 @@ int executeSingleImage(cv::Mat& src) {
 
     cv::Mat labelMap;
     int numOfRegions = regionGrowing(cleanedImg, labelMap, 255);
-    //int numOfRegions = cv::connectedComponents(cleanedImg, labelImg);
 
     printf("number of regions: %d\n", numOfRegions);
 
@@ -241,8 +926,7 @@ int executeSingleImage(cv::Mat& src) {
     cv::imshow("Region Image", regionImage);
 
     cv::Mat largestRegionImage;
-    int areaOfLargestRegion;
-    int largestRegionId = filterOnlylargestRegion(cleanedImg, labelMap, largestRegionImage, numOfRegions);
+    filterOnlylargestRegion(cleanedImg, labelMap, largestRegionImage, numOfRegions);
     cv::namedWindow("largest region", cv::WINDOW_AUTOSIZE);
     cv::imshow("largest region", largestRegionImage);
 
@@ -13,5 +13,94 @@
 
 #include <opencv2/core.hpp>
 
+#include <string>
+#include <vector>
+
+#include "imageProcessing.h"
+
+class FrameSource;
+class ResultPublisher;
+
+// Settings for a run of the video pipeline
+struct VideoFeedOptions {
+	// run without a window or key input, e.g. for measuring
+	// throughput on a machine without a display
+	bool headless = false;
+	// stop after this many frames, 0 to run until the source
+	// ends (or q is pressed)
+	int maxFrames = 0;
+	// when set, every frame's result is published to it
+	ResultPublisher* resultPublisher = nullptr;
+	// threshold method the loop starts with, a toggles it
+	SegmentationOptions segmentation;
+	// time budget per frame (read to result ready) in ms. When frames
+	// run over it, quality is stepped down (see frameScheduler.h).
+	// 0 always runs at full quality.
+	double frameBudgetMs = 0;
+	// entries of the classification cache (0 turns it off) and its
+	// grid step in std devs, see classificationCache.h
+	int classificationCacheSize = 256;
+	double classificationCacheGrid = 0.05;
+	// k and std_multiplier of the kNN classifier, see
+	// executeEvaluation for choosing them
+	int knnK = 2;
+	float stdMultiplier = 1;
+};
+
 // executes the pipeline for live video feed
-int executeVideoFeed();
\ No newline at end of file
+int executeVideoFeed();
+
+// executes the pipeline on frames from any frame source
+// Params:
+//	frameSource: where frames are read from
+//	options:     settings of the run
+//
+// Prints throughput and latency when done. Returns status of run.
+int executeVideoFeed(FrameSource& frameSource, const VideoFeedOptions& options);
+
+// executes one pipeline per frame source, each on its own thread
+// with its own thread pool (cores split evenly between the streams),
+// all classifying against one shared db (see sharedFeatureDB.h).
+// Samples captured on any stream are published to all of them.
+// This thread shows a window per stream and reads the keys, which
+// act on the selected stream (1-9 selects). resultPublisher is not
+// used. maxFrames applies to each stream.
+// Params:
+//	frameSources: where frames are read from, one stream each
+//	options:      settings of every stream
+//
+// Prints throughput and latency of each stream and in total when done.
+// Returns status of run.
+int executeMultiStreamFeed(const std::vector<FrameSource*>& frameSources, const VideoFeedOptions& options);
+
+// Builds db rows from a folder of labelled images laid out as
+// imageDir/<label>/<image>. Every image goes through the same
+// segmentation and features as the live feed, on all cores.
+// Params:
+//	imageDir:   root folder of the labelled images
+//	dbFilename: db file the new rows are appended to
+//	augment:    also add rotated and scaled copies of each image
+//
+// Returns number of rows written, -1 on error or if dbFilename
+// holds another feature schema.
+int executeBulkTraining(std::string imageDir, std::string dbFilename, bool augment);
+
+// Shows every step of the segmentation of a single image, each in its
+// own window, until q is pressed. For development purposes.
+// Params:
+//	src:     BGR image
+//	options: threshold method and its settings, as in the video feed
+//
+// Returns status of run.
+int executeSingleImage(cv::Mat& src, const SegmentationOptions& options = SegmentationOptions());
+
+// Times the otsu and adaptive thresholds (and the whole segmentation
+// with each) on frames from a frame source, next to OpenCV's
+// adaptiveThreshold at the same window size.
+// Params:
+//	frameSource: where frames are read from
+//	numFrames:   number of frames to time
+//	options:     adaptive window and offset
+//
+// Prints mean time per frame of each. Returns status of run.
+int executeThresholdBenchmark(FrameSource& frameSource, int numFrames, const SegmentationOptions& options);
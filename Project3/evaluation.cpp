@@ -0,0 +1,358 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    evaluation.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the offline evaluator of the
+			kNN classifier. Every row of the db is classified
+			against the rest (leave one out), for a grid of k
+			and std_multiplier, to pick the values the video
+			loop runs with.
+ */
+
+#include <cstdio>
+#include <cfloat>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "evaluation.h"
+#include "threadPool.h"
+
+// query rows per block, their maxK closest rows per label stay in cache
+static const int ROW_BLOCK = 64;
+// db rows per tile, 1024 rows of 9 features is 72KB (fits in L2)
+// and is stored feature by feature for the distance loop
+static const int COLUMN_BLOCK = 1024;
+// std_multipliers swept for every k
+static const float STD_MULTIPLIERS[] = { 0.1f, 0.25f, 0.5f, 0.75f, 1.0f, 1.5f, 2.0f, 3.0f, 5.0f, FLT_MAX };
+// confusion matrices with more labels are summarized per label
+static const int MAX_PRINTED_CONFUSION_LABELS = 30;
+
+// Classifies every row of db against all other rows
+int computeLeaveOneOut(const FeatureDB& db, int maxK, LeaveOneOutResult& result)
+{
+	int numRows = static_cast<int>(db.allFeatures.size());
+	if (numRows < 2 || maxK < 1) {
+		return -1;
+	}
+	for (const FeatureVector& row : db.allFeatures) {
+		if (row.schemaId != db.schemaId) {
+			return -1;
+		}
+	}
+
+	// label ids in set order, like kNearestNeigborDistance
+	std::set<std::string> setOfLabels(db.labels.begin(), db.labels.end());
+	result.maxK = maxK;
+	result.labelNames.assign(setOfLabels.begin(), setOfLabels.end());
+	std::map<std::string, int> labelIds;
+	for (int i = 0; i < result.labelNames.size(); i++) {
+		labelIds[result.labelNames[i]] = i;
+	}
+	int numLabels = static_cast<int>(result.labelNames.size());
+	result.rowLabelIds.resize(numRows);
+	std::vector<int> labelCounts(numLabels, 0);
+	for (int i = 0; i < numRows; i++) {
+		result.rowLabelIds[i] = labelIds[db.labels[i]];
+		labelCounts[result.rowLabelIds[i]]++;
+	}
+
+	// features divided by their std dev once, packed for the kernel.
+	// A feature that never changes gets 1 so it does not divide by 0,
+	// the threshold uses the real sum like the classifier.
+	FeatureVector stdDeviations;
+	getStandardDeviation(db.allFeatures, stdDeviations);
+	double sumOfStdDev = 0;
+	for (int j = 0; j < NUM_SHAPE_FEATURES; j++) {
+		sumOfStdDev = sumOfStdDev + stdDeviations[j];
+	}
+	std::vector<double> scaled(static_cast<size_t>(numRows) * NUM_SHAPE_FEATURES);
+	for (int i = 0; i < numRows; i++) {
+		for (int j = 0; j < NUM_SHAPE_FEATURES; j++) {
+			double stdDev = stdDeviations[j] > 0 ? stdDeviations[j] : 1;
+			scaled[static_cast<size_t>(i) * NUM_SHAPE_FEATURES + j] = db.allFeatures[i][j] / stdDev;
+		}
+	}
+
+	size_t numEntries = static_cast<size_t>(numRows) * maxK;
+	result.bestLabel.assign(numEntries, -1);
+	result.bestDistance.assign(numEntries, FLT_MAX);
+	result.otherDistance.assign(numEntries, FLT_MAX);
+
+	int numBlocks = (numRows + ROW_BLOCK - 1) / ROW_BLOCK;
+	getSharedThreadPool().parallelFor(numBlocks, [&](int firstBlock, int endBlock, int) {
+		// maxK closest distances (squared) of each row of the block
+		// to each label, ascending
+		std::vector<double> closest(static_cast<size_t>(ROW_BLOCK) * numLabels * maxK);
+		// the tile's features one feature after the other, and the
+		// distances of one query row to the tile
+		std::vector<double> tile(static_cast<size_t>(NUM_SHAPE_FEATURES) * COLUMN_BLOCK);
+		std::vector<double> distances(COLUMN_BLOCK);
+		for (int block = firstBlock; block < endBlock; block++) {
+			int rowBegin = block * ROW_BLOCK;
+			int rowEnd = std::min(rowBegin + ROW_BLOCK, numRows);
+			std::fill(closest.begin(), closest.end(), DBL_MAX);
+
+			// one tile of the distance matrix at a time
+			for (int columnBegin = 0; columnBegin < numRows; columnBegin += COLUMN_BLOCK) {
+				int columnEnd = std::min(columnBegin + COLUMN_BLOCK, numRows);
+				int tileColumns = columnEnd - columnBegin;
+				for (int j = 0; j < tileColumns; j++) {
+					for (int f = 0; f < NUM_SHAPE_FEATURES; f++) {
+						tile[static_cast<size_t>(f) * COLUMN_BLOCK + j] = scaled[static_cast<size_t>(columnBegin + j) * NUM_SHAPE_FEATURES + f];
+					}
+				}
+
+				for (int i = rowBegin; i < rowEnd; i++) {
+					const double* query = &scaled[static_cast<size_t>(i) * NUM_SHAPE_FEATURES];
+					double* rowClosest = &closest[static_cast<size_t>(i - rowBegin) * numLabels * maxK];
+					// feature by feature over the whole tile, so it vectorizes
+					std::fill(distances.begin(), distances.begin() + tileColumns, 0.0);
+					for (int f = 0; f < NUM_SHAPE_FEATURES; f++) {
+						const double* column = &tile[static_cast<size_t>(f) * COLUMN_BLOCK];
+						double value = query[f];
+						for (int j = 0; j < tileColumns; j++) {
+							double diff = value - column[j];
+							distances[j] = distances[j] + diff * diff;
+						}
+					}
+
+					for (int j = 0; j < tileColumns; j++) {
+						// leave the row itself out
+						if (columnBegin + j == i) {
+							continue;
+						}
+						// most rows are further than the label's maxK-th
+						double distanceSum = distances[j];
+						double* labelClosest = rowClosest + static_cast<size_t>(result.rowLabelIds[columnBegin + j]) * maxK;
+						if (distanceSum < labelClosest[maxK - 1]) {
+							int pos = maxK - 1;
+							while (pos > 0 && labelClosest[pos - 1] > distanceSum) {
+								labelClosest[pos] = labelClosest[pos - 1];
+								pos--;
+							}
+							labelClosest[pos] = distanceSum;
+						}
+					}
+				}
+			}
+
+			// lowest k sum over the labels, for every k
+			for (int i = rowBegin; i < rowEnd; i++) {
+				const double* rowClosest = &closest[static_cast<size_t>(i - rowBegin) * numLabels * maxK];
+				int ownLabel = result.rowLabelIds[i];
+				std::vector<double> best(maxK, DBL_MAX), bestOther(maxK, DBL_MAX);
+				std::vector<int> bestLabel(maxK, -1);
+				for (int label = 0; label < numLabels; label++) {
+					// rows of this label other than i
+					int available = labelCounts[label] - (label == ownLabel ? 1 : 0);
+					if (available == 0) {
+						continue;
+					}
+					double finalDistance = 0;
+					for (int k = 1; k <= maxK; k++) {
+						// fewer than k rows sums the ones there are
+						if (k <= available) {
+							finalDistance = finalDistance + rowClosest[static_cast<size_t>(label) * maxK + k - 1];
+						}
+						// first label in set order wins a tie, like the classifier
+						if (finalDistance < best[k - 1]) {
+							best[k - 1] = finalDistance;
+							bestLabel[k - 1] = label;
+						}
+						if (label != ownLabel && finalDistance < bestOther[k - 1]) {
+							bestOther[k - 1] = finalDistance;
+						}
+					}
+				}
+				for (int k = 1; k <= maxK; k++) {
+					size_t entry = static_cast<size_t>(i) * maxK + k - 1;
+					result.bestLabel[entry] = bestLabel[k - 1];
+					// same float division as the classifier's threshold
+					if (bestLabel[k - 1] >= 0) {
+						result.bestDistance[entry] = static_cast<float>(best[k - 1] / sumOfStdDev);
+					}
+					if (bestOther[k - 1] < DBL_MAX) {
+						result.otherDistance[entry] = static_cast<float>(bestOther[k - 1] / sumOfStdDev);
+					}
+				}
+			}
+		}
+	});
+	return numRows;
+}
+
+// Counts the decisions of result for one k and std_multiplier
+void evaluateSetting(const LeaveOneOutResult& result, int k, float std_multiplier,
+	bool withConfusion, EvaluationCounts& counts)
+{
+	int numLabels = static_cast<int>(result.labelNames.size());
+	int numRows = static_cast<int>(result.rowLabelIds.size());
+	counts = EvaluationCounts();
+	counts.k = k;
+	counts.stdMultiplier = std_multiplier;
+	if (withConfusion) {
+		counts.confusion.assign(numLabels, std::vector<int>(numLabels + 1, 0));
+	}
+	if (k < 1 || k > result.maxK) {
+		return;
+	}
+
+	for (int i = 0; i < numRows; i++) {
+		size_t entry = static_cast<size_t>(i) * result.maxK + k - 1;
+		int trueLabel = result.rowLabelIds[i];
+		if (result.bestLabel[entry] < 0) {
+			continue;
+		}
+		counts.numRows++;
+		int predicted = result.bestDistance[entry] > std_multiplier ? numLabels : result.bestLabel[entry];
+		if (predicted == numLabels) {
+			counts.unknown++;
+		}
+		else if (predicted == trueLabel) {
+			counts.correct++;
+		}
+		else {
+			counts.wrong++;
+		}
+		if (withConfusion) {
+			counts.confusion[trueLabel][predicted]++;
+		}
+
+		// as if the row was an object the db has never seen
+		if (result.otherDistance[entry] < FLT_MAX) {
+			counts.numHeldOut++;
+			if (result.otherDistance[entry] > std_multiplier) {
+				counts.rejected++;
+			}
+		}
+	}
+}
+
+static double percent(int count, int total) {
+	return total > 0 ? 100.0 * count / total : 0.0;
+}
+
+static std::string multiplierName(float std_multiplier) {
+	if (std_multiplier == FLT_MAX) {
+		return "off";
+	}
+	char name[32];
+	snprintf(name, sizeof(name), "%g", std_multiplier);
+	return name;
+}
+
+// prints the confusion matrix, or recall per label when there are many
+static void printConfusion(const LeaveOneOutResult& result, const EvaluationCounts& counts) {
+	int numLabels = static_cast<int>(result.labelNames.size());
+	printf("\nk = %d, std_multiplier = %s: %.1f%% correct, %.1f%% unknown, %.1f%% rejected\n",
+		counts.k, multiplierName(counts.stdMultiplier).c_str(), percent(counts.correct, counts.numRows),
+		percent(counts.unknown, counts.numRows), percent(counts.rejected, counts.numHeldOut));
+
+	if (numLabels > MAX_PRINTED_CONFUSION_LABELS) {
+		printf("%-20s %8s %9s %9s %9s\n", "label", "rows", "correct", "unknown", "wrong");
+		for (int label = 0; label < numLabels; label++) {
+			const std::vector<int>& row = counts.confusion[label];
+			int total = 0;
+			for (int count : row) {
+				total += count;
+			}
+			int unknown = row[numLabels];
+			int correct = row[label];
+			printf("%-20s %8d %8.1f%% %8.1f%% %8.1f%%\n", result.labelNames[label].c_str(), total,
+				percent(correct, total), percent(unknown, total), percent(total - correct - unknown, total));
+		}
+		return;
+	}
+
+	// true labels down, predicted across
+	printf("%-12s", "true \\ pred");
+	for (int label = 0; label < numLabels; label++) {
+		printf(" %7.7s", result.labelNames[label].c_str());
+	}
+	printf(" %7s\n", "Unkown");
+	for (int label = 0; label < numLabels; label++) {
+		printf("%-12.12s", result.labelNames[label].c_str());
+		for (int count : counts.confusion[label]) {
+			printf(" %7d", count);
+		}
+		printf("\n");
+	}
+}
+
+// Reads dbFile and sweeps k and std_multiplier over the leave one out result
+int executeEvaluation(const std::string& dbFile, int maxK, int currentK, float currentStdMultiplier,
+	const std::string& outputFile)
+{
+	FeatureDB db;
+	if (readDBFile(dbFile, db) != 1) {
+		printf("Unable to read %s\n", dbFile.c_str());
+		return -1;
+	}
+	maxK = std::max(maxK, currentK);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	LeaveOneOutResult result;
+	if (computeLeaveOneOut(db, maxK, result) < 0) {
+		printf("%s needs at least 2 rows of one schema to evaluate\n", dbFile.c_str());
+		return -1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%s: %zu rows, %zu labels, leave one out for k = 1..%d in %.2f s on %d threads\n",
+		dbFile.c_str(), db.allFeatures.size(), result.labelNames.size(), maxK, seconds,
+		getSharedThreadPool().concurrency());
+
+	FILE* csv = NULL;
+	if (!outputFile.empty()) {
+		csv = fopen(outputFile.c_str(), "w");
+		if (csv == NULL) {
+			printf("unable to write %s\n", outputFile.c_str());
+		}
+		else {
+			fprintf(csv, "k,std_multiplier,rows,correct,wrong,unknown,held_out,rejected\n");
+		}
+	}
+
+	// best setting by the mean of accuracy and rejection rate
+	EvaluationCounts counts;
+	int bestK = currentK;
+	float bestMultiplier = currentStdMultiplier;
+	double bestScore = -1;
+	printf("\n%3s %9s %9s %9s %9s %9s\n", "k", "std mult", "correct", "unknown", "wrong", "rejected");
+	for (int k = 1; k <= maxK; k++) {
+		for (float std_multiplier : STD_MULTIPLIERS) {
+			evaluateSetting(result, k, std_multiplier, false, counts);
+			double accuracy = percent(counts.correct, counts.numRows);
+			double rejection = percent(counts.rejected, counts.numHeldOut);
+			printf("%3d %9s %8.1f%% %8.1f%% %8.1f%% %8.1f%%\n", k, multiplierName(std_multiplier).c_str(),
+				accuracy, percent(counts.unknown, counts.numRows), percent(counts.wrong, counts.numRows), rejection);
+			if (csv != NULL) {
+				fprintf(csv, "%d,%s,%d,%d,%d,%d,%d,%d\n", k, multiplierName(std_multiplier).c_str(), counts.numRows,
+					counts.correct, counts.wrong, counts.unknown, counts.numHeldOut, counts.rejected);
+			}
+			double score = (accuracy + rejection) / 2;
+			if (score > bestScore) {
+				bestScore = score;
+				bestK = k;
+				bestMultiplier = std_multiplier;
+			}
+		}
+	}
+	if (csv != NULL) {
+		fclose(csv);
+		printf("settings written to %s\n", outputFile.c_str());
+	}
+
+	printf("\ncurrent setting");
+	evaluateSetting(result, currentK, currentStdMultiplier, true, counts);
+	printConfusion(result, counts);
+	printf("\nbest setting (mean of correct and rejected)");
+	evaluateSetting(result, bestK, bestMultiplier, true, counts);
+	printConfusion(result, counts);
+	return 0;
+}
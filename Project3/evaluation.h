@@ -0,0 +1,76 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    evaluation.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the offline evaluator of the
+			kNN classifier. Every row of the db is classified
+			against the rest (leave one out), for a grid of k
+			and std_multiplier, to pick the values the video
+			loop runs with.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "featureExtraction.h"
+
+// Leave one out kNN decision of every row, for k = 1..maxK.
+// Entries of the per row arrays are at row * maxK + (k - 1).
+struct LeaveOneOutResult {
+	int maxK = 0;
+	// labels in set order, like the classifier
+	std::vector<std::string> labelNames;
+	// true label of each row
+	std::vector<int> rowLabelIds;
+	// label with the lowest k sum, -1 if there is no other row
+	std::vector<int> bestLabel;
+	// its distance in std devs, the value compared with std_multiplier
+	std::vector<float> bestDistance;
+	// lowest distance among the other labels, i.e. the distance the
+	// row would get if its own label was not in the db. FLT_MAX if
+	// there is no other label.
+	std::vector<float> otherDistance;
+};
+
+// Classifies every row of db against all other rows, the same way
+// kNearestNeigborDistance does, for k = 1..maxK at once.
+// The distance matrix is computed once, in tiles that fit in cache,
+// on the shared thread pool. Each tile is reduced straight into the
+// maxK closest rows of every label, which is all any k and
+// std_multiplier needs, so the n x n matrix is never stored.
+// Std devs are those of the whole db (not of the db without the row).
+// Returns number of rows evaluated, -1 if the db can not be evaluated
+int computeLeaveOneOut(const FeatureDB& db, int maxK, LeaveOneOutResult& result);
+
+// Counts for one k and std_multiplier
+struct EvaluationCounts {
+	int k = 0;
+	float stdMultiplier = 0;
+	int numRows = 0;    // rows classified
+	int correct = 0;    // own label
+	int wrong = 0;      // another label
+	int unknown = 0;    // "Unkown" although the label is in the db
+	int numHeldOut = 0; // rows with another label to fall back to
+	int rejected = 0;   // "Unkown" when their own label is left out
+	// [true label][predicted label], the last column is "Unkown".
+	// Only filled when asked for.
+	std::vector<std::vector<int>> confusion;
+};
+
+// Counts the decisions of result for one k and std_multiplier
+void evaluateSetting(const LeaveOneOutResult& result, int k, float std_multiplier,
+	bool withConfusion, EvaluationCounts& counts);
+
+// Reads dbFile, runs computeLeaveOneOut and sweeps k = 1..maxK over a
+// grid of std_multipliers. Prints accuracy, unknown and rejection rates
+// of every setting and the confusion matrices of the current setting
+// (currentK, currentStdMultiplier) and the best one. Every setting is
+// written to outputFile (csv) unless it is empty.
+// Returns 0 on success, -1 if the db can not be read or evaluated
+int executeEvaluation(const std::string& dbFile, int maxK, int currentK, float currentStdMultiplier,
+	const std::string& outputFile);
@@ -27,33 +27,32 @@
 #include <fstream>
 #include <map>
 #include <set>
+#include <functional>
+#include <algorithm>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "featureExtraction.h"
 #include "imageProcessing.h"
-
-// Function to read db file and return a vector of all feature vectors + label vector
-int readDBFile(std::string filename,
-	std::vector<std::vector<double>>& allFeatures,
-	std::vector<std::string>& labels);
-
-// Generates a vector of features
-// {percetangeFilled, h/w ratio, moment around axis of least central moment}
-// Input is a binary image with only 1 region
-int getFeatures(const cv::Mat& src, std::vector<double>& featureVector) {
-
-	// reset vector
-	featureVector.clear();
-
+#include "threadPool.h"
+#include "regionBoundary.h"
+
+// builds the feature vector from the moments, area and
+// rotated bounding box of a region
+static void featuresFromRegion(const cv::Moments& moments,
+	int regionArea,
+	const cv::RotatedRect& rotatedBB,
+	FeatureVector& featureVector)
+{
 	// Moment around central axis 
-	cv::Moments moments = cv::moments(src, true);
 	double hu[7];
 	cv::HuMoments(moments, hu);
 
-	// find rotated bounding box points	
-	std::vector<cv::Point> regionPoints;
-	cv::findNonZero(src, regionPoints);
-	cv::RotatedRect rotatedBB = cv::minAreaRect(regionPoints);
-
 	// calculate the area of the rotated bounding box
 	double width = rotatedBB.size.width;
 	double height = rotatedBB.size.height;
@@ -71,97 +70,248 @@ int getFeatures(const cv::Mat& src, std::vector<double>& featureVector) {
 	// h/w ratio
 	double hwRatio = std::max(rotatedHeight, rotatedWidth) / std::min(rotatedHeight, rotatedWidth);
 	// percentage filled
-	int regionArea = cv::countNonZero(src);
 	double percentFilled = static_cast<double>(regionArea) / rotatedArea * 100.0;
 
-	// add to vector
-	featureVector.push_back(percentFilled);
-	featureVector.push_back(hwRatio);
+	// fill in record
+	featureVector.schemaId = FEATURE_SCHEMA_SHAPE_V1;
+	featureVector[0] = percentFilled;
+	featureVector[1] = hwRatio;
 	for (int i = 0; i < 7; i++) {
-		featureVector.push_back(hu[i]);
+		featureVector[2 + i] = hu[i];
 	}
+}
+
+// Generates a vector of features
+// {percetangeFilled, h/w ratio, moment around axis of least central moment}
+// Input is a binary image with only 1 region
+int getFeatures(const cv::Mat& src, FeatureVector& featureVector) {
+
+	cv::Moments moments = cv::moments(src, true);
+
+	// rotated bounding box from the traced outer boundary
+	RegionBoundary boundary;
+	getRegionBoundary(src, 255, boundary);
+
+	featuresFromRegion(moments, static_cast<int>(moments.m00), boundary.boundingBox, featureVector);
+	return 1;
+}
+
+// getFeatures for a region stored as runs.
+// Area and moments come from the runs, the rotated bounding box
+// from the traced outer boundary.
+int getFeatures(const RLEMask& region, FeatureVector& featureVector) {
+
+	cv::Moments moments = getMomentsRLE(region);
+
+	RegionBoundary boundary;
+	getRegionBoundary(region, boundary);
+
+	featuresFromRegion(moments, static_cast<int>(moments.m00), boundary.boundingBox, featureVector);
 	return 1;
 }
 
 // writes a label and its features to a file
-int writeFeaturesToFile(std::vector<double> features, std::string label, std::string filename)
+int writeFeaturesToFile(const FeatureVector& features, const std::string& label, const std::string& filename)
 {
-	std::ofstream outfile(filename, std::ios::app); // open file for writing, appending to existing data if any
-	if (!outfile.is_open()) {
-		std::cerr << "unable to open db file (write)." << std::endl;
+	if (!appendDBRows(filename, formatDBRow(features, label))) {
 		return 0;
 	}
-	// iterate over feature vector and write each double to file, separated by a space
+	printf("Saved %s to file.\n", label.c_str());
+
+	return 1;
+}
+
+// Adds a row to an in-memory db
+void addFeatureRow(FeatureDB& db, const FeatureVector& features, const std::string& label)
+{
+	db.allFeatures.push_back(features);
+	db.labels.push_back(label);
+	db.version++;
+}
+
+// formats a label and its features as one db file line (with newline)
+std::string formatDBRow(const FeatureVector& features, const std::string& label)
+{
+	std::ostringstream row;
+	// iterate over feature vector and write each double, separated by a space
 	for (const double& feature : features) {
-		outfile << feature << " ";
+		row << feature << " ";
 	}
-	// write label to file
-	outfile << label << " " << std::endl;
-	outfile.close(); // close the file
-	printf("Saved %s to file.\n", label.c_str());
+	// write label
+	row << label << " " << std::endl;
+	return row.str();
+}
+
+// flushes a stdio file all the way to disk
+static void flushFileToDisk(FILE* file) {
+	fflush(file);
+#ifdef _WIN32
+	_commit(_fileno(file));
+#else
+	fsync(fileno(file));
+#endif
+}
+
+// Gets the first non blank line of a db file.
+// Returns false if the file is missing or has none.
+static bool firstDBFileLine(const std::string& filename, std::string& line)
+{
+	std::ifstream infile(filename);
+	while (infile.is_open() && std::getline(infile, line)) {
+		if (line.find_first_not_of(" \t\r") != std::string::npos) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// true if the first line of a db file names the current schema.
+// A file without a schema line holds schema 1, the current one.
+static bool isCurrentSchemaLine(const std::string& line)
+{
+	unsigned int schemaId;
+	int numFeatures;
+	if (sscanf(line.c_str(), "#schema %u %d", &schemaId, &numFeatures) != 2) {
+		return true;
+	}
+	return schemaId == FEATURE_SCHEMA_SHAPE_V1 && numFeatures == NUM_SHAPE_FEATURES;
+}
+
+// Checks that rows of the current schema can be appended to a db file
+int checkDBFileSchema(const std::string& filename)
+{
+	std::string line;
+	if (!firstDBFileLine(filename, line)) {
+		return 1;
+	}
+	return isCurrentSchemaLine(line) ? 1 : 0;
+}
 
+// Appends formatted rows to the db file, a new file
+// starts with the schema line
+int appendDBRows(const std::string& filename, const std::string& rows, bool flushToDisk)
+{
+	// rows of another schema would corrupt the file
+	std::string firstLine;
+	bool hasLines = firstDBFileLine(filename, firstLine);
+	if (hasLines && !isCurrentSchemaLine(firstLine)) {
+		std::cerr << "db file " << filename << " holds another feature schema, rows not saved." << std::endl;
+		return 0;
+	}
+	FILE* outfile = fopen(filename.c_str(), "a");
+	if (outfile == NULL) {
+		std::cerr << "unable to open db file (write)." << std::endl;
+		return 0;
+	}
+	if (!hasLines) {
+		fprintf(outfile, "#schema %u %d\n", (unsigned int)FEATURE_SCHEMA_SHAPE_V1, NUM_SHAPE_FEATURES);
+	}
+	fputs(rows.c_str(), outfile);
+	if (flushToDisk) {
+		flushFileToDisk(outfile);
+	}
+	fclose(outfile);
 	return 1;
-}	
+}
 
-// Function to read db file and return a vector of all feature vectors + label vector
-int readDBFile(std::string filename,
-	std::vector<std::vector<double>>& allFeatures,
-	std::vector<std::string>& labels)
+// reads the db file into an in-memory db.
+// Rows are parsed straight into the db records, the only
+// allocations are for the labels and growing the db.
+int readDBFile(const std::string& filename, FeatureDB& db)
 {
+	db.schemaId = FEATURE_SCHEMA_SHAPE_V1;
+	db.allFeatures.clear();
+	db.labels.clear();
+	db.version++;
+
 	std::ifstream infile(filename);
 	if (!infile.is_open()) {
 		std::cerr << "unable to open db file (read)." << std::endl;
 		return 0;
 	}
 
-	// read file in a vector of feature vectors
 	std::string line;
-	allFeatures.clear();
-	labels.clear();
+	int lineNumber = 0;
 	while (std::getline(infile, line)) {
-		// read line
-		std::istringstream iss(line);
-		// create feature vector
-		std::vector<double> features;
-		// var to hold a feature
-		double feature;
-		for (int i = 0; i < 9; i++) {
-			iss >> feature;
-			features.push_back(feature);
+		lineNumber++;
+		// schema line, files written before it was added have none
+		if (!line.empty() && line[0] == '#') {
+			unsigned int schemaId;
+			int numFeatures;
+			if (sscanf(line.c_str(), "#schema %u %d", &schemaId, &numFeatures) == 2
+				&& (schemaId != FEATURE_SCHEMA_SHAPE_V1 || numFeatures != NUM_SHAPE_FEATURES)) {
+				std::cerr << "db file " << filename << " has schema " << schemaId << " (" << numFeatures
+					<< " features), expected " << FEATURE_SCHEMA_SHAPE_V1 << " (" << NUM_SHAPE_FEATURES
+					<< " features)." << std::endl;
+				db.allFeatures.clear();
+				db.labels.clear();
+				return 0;
+			}
+			continue;
+		}
+
+		// read features in place
+		db.allFeatures.emplace_back();
+		FeatureVector& features = db.allFeatures.back();
+		features.schemaId = FEATURE_SCHEMA_SHAPE_V1;
+		const char* cursor = line.c_str();
+		bool complete = true;
+		for (int i = 0; i < NUM_SHAPE_FEATURES && complete; i++) {
+			char* next;
+			features[i] = strtod(cursor, &next);
+			complete = next != cursor;
+			cursor = next;
+		}
+		if (!complete) {
+			// skip blank or short lines
+			db.allFeatures.pop_back();
+			if (line.find_first_not_of(" \t\r") != std::string::npos) {
+				std::cerr << "skipping short row " << lineNumber << " of " << filename << std::endl;
+			}
+			continue;
 		}
-		allFeatures.push_back(features);
 
 		// read label at end of line
-		std::string label;
-		iss >> label;
-		labels.push_back(label);
+		while (*cursor == ' ' || *cursor == '\t') {
+			cursor++;
+		}
+		const char* labelEnd = cursor;
+		while (*labelEnd != '\0' && *labelEnd != ' ' && *labelEnd != '\t' && *labelEnd != '\r') {
+			labelEnd++;
+		}
+		db.labels.emplace_back(cursor, labelEnd);
 	}
 	infile.close();
 	return 1;
 }
 
 // calculates standard deviation of each feature in a file
-int getStandardDeviation(std::vector<std::vector<double>> allFeatures, std::vector<double> &stdDeviations) {
+int getStandardDeviation(const std::vector<FeatureVector>& allFeatures, FeatureVector& stdDeviations) {
 
-	// reset stdDeviations vector
-	stdDeviations.clear();
+	stdDeviations.schemaId = allFeatures.empty() ? FEATURE_SCHEMA_NONE : allFeatures[0].schemaId;
+	if (allFeatures.empty()) {
+		for (double& stdDev : stdDeviations) {
+			stdDev = 0;
+		}
+		return 0;
+	}
 
 	// find mean
-	std::vector<double> means;
+	FeatureVector means;
 	// for each feature in a feature vector
-	for (int featureIdx = 0; featureIdx < allFeatures[0].size(); featureIdx++) {
+	for (int featureIdx = 0; featureIdx < NUM_SHAPE_FEATURES; featureIdx++) {
 		double sum = 0, mean = 0;
 		// for each feature vector in all features
 		for (int allFeaturesIdx = 0; allFeaturesIdx < allFeatures.size(); allFeaturesIdx++) {
 			sum = sum + allFeatures[allFeaturesIdx][featureIdx];
 		}
 		mean = sum / allFeatures.size();
-		means.push_back(mean);
+		means[featureIdx] = mean;
 	}
 
 	// find std dev
 	// for each feature in a feature vector
-	for (int featureIdx = 0; featureIdx < allFeatures[0].size(); featureIdx++) {
+	for (int featureIdx = 0; featureIdx < NUM_SHAPE_FEATURES; featureIdx++) {
 		double sum = 0;
 		// for each feature vector in all features
 		for (int allFeaturesIdx = 0; allFeaturesIdx < allFeatures.size(); allFeaturesIdx++) {
@@ -169,20 +319,99 @@ int getStandardDeviation(std::vector<std::vector<double>> allFeatures, std::vect
 			sum = sum + diff*diff;
 		}
 		double stdDev = sqrt(sum / allFeatures.size());
-		stdDeviations.push_back(stdDev);
-	}
-	//for (int i = 0; i < stdDeviations.size(); i++) {
-	//	printf("mean[%d]: %f; ", i, means[i]);
-	//}
-	//printf("\n");
-	//for (int i = 0; i < stdDeviations.size(); i++) {
-	//	printf("Stddev[%d]: %f; ", i, stdDeviations[i]);
-	//}
-	//printf("\n");
-	//for (int i = 0; i < labels.size(); i++) {
-	//	printf("labels[%d]: %s; ", i, labels[i].c_str());
-	//}
-	return 1;	
+		stdDeviations[featureIdx] = stdDev;
+	}
+	return 1;
+}
+
+// DBs with fewer rows than this are scanned on the calling
+// thread, where dispatching to the pool costs more than it saves
+static const int PARALLEL_SCAN_MIN_ROWS = 4096;
+
+// scaled euclidean distance (squared) between two feature vectors
+static double scaledDistance(const FeatureVector& targetFeatures,
+	const FeatureVector& dbFeatures,
+	const FeatureVector& stdDeviations)
+{
+	double distanceSum = 0;
+	// for each feature
+	for (int j = 0; j < NUM_SHAPE_FEATURES; j++) {
+		double distanceScaled = (targetFeatures[j] - dbFeatures[j]) / stdDeviations[j];
+		double distanceSquared = distanceScaled * distanceScaled;
+		distanceSum = distanceSum + distanceSquared;
+	}
+	return distanceSum;
+}
+
+// A feature that never changes can not tell rows apart, scale it
+// by 1 instead of dividing by 0 (computeLeaveOneOut does the same)
+static void replaceZeroStandardDeviations(FeatureVector& stdDeviations)
+{
+	for (int j = 0; j < NUM_SHAPE_FEATURES; j++) {
+		if (stdDeviations[j] == 0) {
+			stdDeviations[j] = 1;
+		}
+	}
+}
+
+// Number of chunks scanDB splits numRows rows into. Small dbs are
+// a single chunk, and do not start the shared thread pool.
+static int scanDBChunks(int numRows)
+{
+	if (numRows < PARALLEL_SCAN_MIN_ROWS) {
+		return 1;
+	}
+	return std::min(numRows, getSharedThreadPool().concurrency());
+}
+
+// Runs scanRange(begin, end, chunkIdx) over all rows of the db,
+// on the shared thread pool for large dbs and on the calling
+// thread otherwise, with chunkIdx below scanDBChunks(numRows).
+static void scanDB(int numRows, const std::function<void(int, int, int)>& scanRange)
+{
+	if (numRows < PARALLEL_SCAN_MIN_ROWS) {
+		scanRange(0, numRows, 0);
+		return;
+	}
+	getSharedThreadPool().parallelFor(numRows, scanRange);
+}
+
+// Removes rows that are within minDistance (scaled euclidean)
+// of an earlier row with the same label.
+// Returns number of rows removed.
+int removeNearDuplicates(FeatureDB& db, double minDistance)
+{
+	if (db.allFeatures.size() < 2) {
+		return 0;
+	}
+	FeatureVector stdDeviations;
+	getStandardDeviation(db.allFeatures, stdDeviations);
+	replaceZeroStandardDeviations(stdDeviations);
+
+	// rows kept so far, grouped by label
+	std::map<std::string, std::vector<int>> keptRows;
+	FeatureDB dedupedDB;
+	dedupedDB.schemaId = db.schemaId;
+	dedupedDB.version = db.version + 1;
+	for (int i = 0; i < db.allFeatures.size(); i++) {
+		std::vector<int>& sameLabelRows = keptRows[db.labels[i]];
+		bool duplicate = false;
+		for (int keptIdx : sameLabelRows) {
+			if (scaledDistance(db.allFeatures[i], dedupedDB.allFeatures[keptIdx], stdDeviations) < minDistance) {
+				duplicate = true;
+				break;
+			}
+		}
+		if (!duplicate) {
+			sameLabelRows.push_back(static_cast<int>(dedupedDB.allFeatures.size()));
+			dedupedDB.allFeatures.push_back(db.allFeatures[i]);
+			dedupedDB.labels.push_back(db.labels[i]);
+		}
+	}
+
+	int removed = static_cast<int>(db.allFeatures.size() - dedupedDB.allFeatures.size());
+	db = dedupedDB;
+	return removed;
 }
 
 // Closet neighbor classifer
@@ -190,19 +419,27 @@ int getStandardDeviation(std::vector<std::vector<double>> allFeatures, std::vect
 // cumalative distance between features (scaled euclidean).
 // Output is a string
 // Returns the row index of the nearest neighbor in db
-int nearestNeigborDistance(std::vector<double> targetFeatures,
-	std::string filename,
+int nearestNeigborDistance(const FeatureVector& targetFeatures,
+	const std::string& filename,
 	std::string& outputLabel)
 {
-
-	std::vector<std::vector<double>> allFeatures;
-	std::vector<std::string> labels;
+	FeatureDB db;
 	bool readStatus = 0;
-	readStatus = readDBFile(filename, allFeatures, labels);
+	readStatus = readDBFile(filename, db);
 	if (!readStatus) {
 		outputLabel = "no db file";
 		return -1;
 	}
+	return nearestNeigborDistance(targetFeatures, db, outputLabel);
+}
+
+// Closet neighbor classifer against an in-memory db
+int nearestNeigborDistance(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
+	std::string& outputLabel)
+{
+	const std::vector<FeatureVector>& allFeatures = db.allFeatures;
+	const std::vector<std::string>& labels = db.labels;
 
 	// edge cases
 	if (labels.size() == 1) {
@@ -213,32 +450,53 @@ int nearestNeigborDistance(std::vector<double> targetFeatures,
 		outputLabel = "No data in db file";
 		return 0;
 	}
+	else if (targetFeatures.schemaId != db.schemaId) {
+		outputLabel = "Schema mismatch";
+		return -1;
+	}
 
 	// get std dev
-	std::vector<double> stdDeviations;
+	FeatureVector stdDeviations;
 	getStandardDeviation(allFeatures, stdDeviations);
+	replaceZeroStandardDeviations(stdDeviations);
+
+	// nearest row found by each chunk of the db
+	int numRows = static_cast<int>(allFeatures.size());
+	int numChunks = scanDBChunks(numRows);
+	std::vector<double> chunkMinDistance(numChunks, DBL_MAX);
+	std::vector<int> chunkNearestIndex(numChunks, -1);
+	scanDB(numRows, [&](int begin, int end, int chunk) {
+		double minDistance = DBL_MAX;
+		int nearestNeigborIndex = -1;
+		// for all data points in this chunk
+		for (int i = begin; i < end; i++) {
+			double distanceSum = scaledDistance(targetFeatures, allFeatures[i], stdDeviations);
+			// if distance to data point < minDistance
+			if (distanceSum < minDistance) {
+				nearestNeigborIndex = i;
+				minDistance = distanceSum;
+			}
+		}
+		chunkMinDistance[chunk] = minDistance;
+		chunkNearestIndex[chunk] = nearestNeigborIndex;
+	});
 
+	// merge chunks in row order, so ties keep the first row
+	// exactly like a single serial scan
 	double minDistance = DBL_MAX;
 	int nearestNeigborIndex = -1;
-	// for all data points in db
-	for (int i = 0; i < allFeatures.size(); i++) {
-
-		// calculate distance to data point
-		double distanceSum = 0;
-		// for each feature
-		for (int j = 0; j < allFeatures[i].size(); j++) {
-			double distanceScaled = (targetFeatures[j] - allFeatures[i][j])/ stdDeviations[j];
-			double distanceSquared = distanceScaled * distanceScaled;
-			distanceSum = distanceSum + distanceSquared;
-		} // for features	
-
-		// if distance to data point < minDistance
-		if (distanceSum < minDistance) {
-			nearestNeigborIndex = i;
-			minDistance = distanceSum;
-		} 	
-	} // for db loop
+	for (int chunk = 0; chunk < numChunks; chunk++) {
+		if (chunkMinDistance[chunk] < minDistance) {
+			minDistance = chunkMinDistance[chunk];
+			nearestNeigborIndex = chunkNearestIndex[chunk];
+		}
+	}
 
+	// every distance was NaN (features of an empty region)
+	if (nearestNeigborIndex < 0) {
+		outputLabel = "Unkown";
+		return -1;
+	}
 	outputLabel = labels[nearestNeigborIndex];
 	return nearestNeigborIndex;
 }
@@ -252,21 +510,46 @@ int nearestNeigborDistance(std::vector<double> targetFeatures,
 // 
 // Output is a string
 // Returns the row index of the nearest neighbor in db
-int kNearestNeigborDistance(std::vector<double> targetFeatures,
-	std::string filename,
+int kNearestNeigborDistance(const FeatureVector& targetFeatures,
+	const std::string& filename,
 	int k,
 	float std_multiplier,
 	std::string& outputLabel)
 {	
 	// get all features and labels
-	std::vector<std::vector<double>> allFeatures;
-	std::vector<std::string> labels;
+	FeatureDB db;
 	bool readStatus = 0;
-	readStatus = readDBFile(filename, allFeatures, labels);
+	readStatus = readDBFile(filename, db);
 	if (!readStatus) {
 		outputLabel = "no db file";
 		return -1;
 	}
+	return kNearestNeigborDistance(targetFeatures, db, k, std_multiplier, outputLabel);
+}
+
+// k-nearest neighbor classifer against an in-memory db
+int kNearestNeigborDistance(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel)
+{
+	double distance;
+	return kNearestNeigborDistance(targetFeatures, db, k, std_multiplier, outputLabel, distance);
+}
+
+// k-nearest neighbor classifer against an in-memory db that also
+// gives the distance to the chosen label, in std devs
+int kNearestNeigborDistance(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel,
+	double& outputDistance)
+{
+	outputDistance = 0;
+	const std::vector<FeatureVector>& allFeatures = db.allFeatures;
+	const std::vector<std::string>& labels = db.labels;
 
 	// edge cases
 	if (labels.size() == 1) {
@@ -277,56 +560,83 @@ int kNearestNeigborDistance(std::vector<double> targetFeatures,
 		outputLabel = "No data in db file";
 		return 0;
 	}
+	else if (targetFeatures.schemaId != db.schemaId) {
+		outputLabel = "Schema mismatch";
+		return -1;
+	}
+	k = std::max(k, 1);
 
-	// get std dev
-	std::vector<double> stdDeviations;
+	// get std dev, the threshold below uses their real sum
+	FeatureVector stdDeviations;
 	getStandardDeviation(allFeatures, stdDeviations);
-
-	// turn labels in a set
-	std::set<std::string> setOfLabels;
-	for (int i = 0; i < labels.size(); i++) {
-		setOfLabels.insert(labels[i]);
+	double sumOfStdDev = 0;
+	for (int i = 0; i < NUM_SHAPE_FEATURES; i++) {
+		sumOfStdDev = sumOfStdDev + stdDeviations[i];
+	}
+	replaceZeroStandardDeviations(stdDeviations);
+
+	// turn labels in a set, and give each label an id
+	// in set order so every row can be binned without string compares
+	std::set<std::string> setOfLabels(labels.begin(), labels.end());
+	std::vector<std::string> labelNames(setOfLabels.begin(), setOfLabels.end());
+	std::map<std::string, int> labelIds;
+	for (int i = 0; i < labelNames.size(); i++) {
+		labelIds[labelNames[i]] = i;
+	}
+	int numRows = static_cast<int>(allFeatures.size());
+	std::vector<int> rowLabelIds(numRows);
+	for (int i = 0; i < numRows; i++) {
+		rowLabelIds[i] = labelIds[labels[i]];
 	}
 
-	double minDistance = DBL_MAX;
-	// for every label
-	for (std::string label : setOfLabels) {
-		// create vector of distances to all labels
-		std::vector<double> distances;
-
-		// for every feature vector in db
-		for (int i = 0; i < allFeatures.size(); i++) {
-
-			// if label is label we want
-			if (labels[i] == label) {
-				// calculate the distance to that data point 
-				// (which is the same label as we want)
-				double distanceSum = 0;
-				// for each feature
-				for (int j = 0; j < allFeatures[i].size(); j++) {
-					double distanceScaled = (targetFeatures[j] - allFeatures[i][j]) / stdDeviations[j];
-					double distanceSquared = distanceScaled * distanceScaled;
-					distanceSum = distanceSum + distanceSquared;
-				} // for each feature
-
-				// add distance to that data point to vector of distances
-				distances.push_back(distanceSum);
+	// each chunk keeps a max heap of its k closest (distance, row)
+	// per label, so only k entries per label are ever merged
+	typedef std::vector<std::pair<double, int>> Heap;
+	size_t heapSize = static_cast<size_t>(k);
+	int numChunks = scanDBChunks(numRows);
+	std::vector<std::vector<Heap>> chunkHeaps(numChunks, std::vector<Heap>(labelNames.size()));
+	scanDB(numRows, [&](int begin, int end, int chunk) {
+		std::vector<Heap>& heaps = chunkHeaps[chunk];
+		// for every feature vector in this chunk
+		for (int i = begin; i < end; i++) {
+			std::pair<double, int> entry(scaledDistance(targetFeatures, allFeatures[i], stdDeviations), i);
+			Heap& heap = heaps[rowLabelIds[i]];
+			if (heap.size() < heapSize) {
+				heap.push_back(entry);
+				std::push_heap(heap.begin(), heap.end());
+			}
+			else if (entry < heap.front()) {
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = entry;
+				std::push_heap(heap.begin(), heap.end());
 			}
 		} // for db loop
+	});
 
-		// once we have all distances to this label:
-		// sort vector and take top k
+	double minDistance = DBL_MAX;
+	int nearestNeigborIndex = -1;
+	// for every label
+	for (int labelId = 0; labelId < labelNames.size(); labelId++) {
+		// gather the candidates of every chunk,
+		// sort and take top k
+		Heap distances;
+		for (int chunk = 0; chunk < numChunks; chunk++) {
+			const Heap& heap = chunkHeaps[chunk][labelId];
+			distances.insert(distances.end(), heap.begin(), heap.end());
+		}
 		std::sort(distances.begin(), distances.end());
-		// sum top k
+		// sum top k (fewer if the label has less than k samples)
+		int topK = std::min(k, static_cast<int>(distances.size()));
 		double finalDistance = 0;
-		for (int i = 0; i < k; i++) {
-			finalDistance = finalDistance + distances[i];
+		for (int i = 0; i < topK; i++) {
+			finalDistance = finalDistance + distances[i].first;
 		}
 
 		// take min final distances amoung all labels
 		if (finalDistance < minDistance) {
 			minDistance = finalDistance;
-			outputLabel = label;
+			outputLabel = labelNames[labelId];
+			nearestNeigborIndex = distances[0].second;
 		} // if
 	} // for each label
 
@@ -337,15 +647,13 @@ int kNearestNeigborDistance(std::vector<double> targetFeatures,
 	* Because min distance is a sum of feature distances
 	*/
 	// Check if distance to nearest neighbor is within std_multiplier standard deviations sum
-	double sumOfStdDev =  0;
-	for (int i = 0; i < stdDeviations.size(); i++) {
-		sumOfStdDev = sumOfStdDev + stdDeviations[i];
-	}
 	float dist_stddev = minDistance / sumOfStdDev;
+	outputDistance = dist_stddev;
 	if (dist_stddev > std_multiplier) {
 		// distance to nearest neighbor is above std_multiplier standard deviations, so prediction is unreliable
 		outputLabel = "Unkown"; 
 		return -1;
 	}
+	return nearestNeigborIndex;
 
-} // func kNearestNeigborDistance()
\ No newline at end of file
+} // func kNearestNeigborDistance()
@@ -11,32 +11,97 @@
 			(Task 5 - 9)
  */
 
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "rleMask.h"
+#include "featureRecord.h"
+
+// In-memory copy of the db file. The video loop classifies
+// against this instead of re-reading the file every frame.
+// Every row follows schemaId.
+struct FeatureDB {
+	uint32_t schemaId = FEATURE_SCHEMA_SHAPE_V1;
+	std::vector<FeatureVector> allFeatures;
+	std::vector<std::string> labels;
+	// bumped on every change, so anything derived from the db
+	// (e.g. a ClassificationCache) knows when it is stale
+	uint64_t version = 0;
+};
+
+// Adds a row to an in-memory db
+void addFeatureRow(FeatureDB& db, const FeatureVector& features, const std::string& label);
+
  // Generates a vector of features
  // {percetangeFilled, h/w ratio, moment around axis of least central moment}
  // Input is a binary image with only 1 region
-int getFeatures(const cv::Mat& src, std::vector<double>& featureVector);
+int getFeatures(const cv::Mat& src, FeatureVector& featureVector);
+
+// getFeatures for a region stored as runs (see rleMask.h).
+// Area and moments come from the runs, without expanding the mask,
+// and the bounding box from the outer boundary only.
+int getFeatures(const RLEMask& region, FeatureVector& featureVector);
 
 // writes a label and its features to a file
-int writeFeaturesToFile(std::vector<double> features,
-	std::string label,
-	std::string filename);
+int writeFeaturesToFile(const FeatureVector& features,
+	const std::string& label,
+	const std::string& filename);
+
+// formats a label and its features as one db file line (with newline)
+std::string formatDBRow(const FeatureVector& features,
+	const std::string& label);
+
+// Appends formatted rows to the db file. A new (empty) file gets
+// the "#schema <id> <numFeatures>" line first, a file of another
+// schema is left alone. With flushToDisk the rows are on disk, not
+// just in the OS cache, when this returns.
+// Returns status of run, 0 if the file can not be opened or holds
+// another schema.
+int appendDBRows(const std::string& filename,
+	const std::string& rows,
+	bool flushToDisk = false);
 
-// Function to read db file and return a vector of all feature vectors + label vector
-int readDBFile(std::string filename, 
-	std::vector<std::vector<double>>& allFeatures,
-	std::vector<std::string>& labels);
+// Checks that rows of the current schema can be appended to a db
+// file: it is missing, empty, has no "#schema" line (schema 1) or
+// starts with the current one.
+// Returns 1 if they can, 0 if the file holds another schema.
+int checkDBFileSchema(const std::string& filename);
+
+// reads the db file into an in-memory db.
+// Files without a "#schema" line are from before it was added and
+// hold FEATURE_SCHEMA_SHAPE_V1 rows.
+// A missing file, or one with a different schema, gives an empty
+// db and returns 0.
+int readDBFile(const std::string& filename, FeatureDB& db);
 
 // calculates standard deviation of each feature from a vector of feature vectors
-int getStandardDeviation(std::vector<std::vector<double>> allFeatures,
-	std::vector<double>& stdDeviations);
+int getStandardDeviation(const std::vector<FeatureVector>& allFeatures,
+	FeatureVector& stdDeviations);
+
+// Removes rows that are within minDistance (scaled euclidean,
+// using the std dev of the whole db) of an earlier row with
+// the same label. The first of each group of duplicates is kept.
+// Returns number of rows removed.
+int removeNearDuplicates(FeatureDB& db, double minDistance);
 
 // Closet neighbor classifer
 // Given a feature vector, find the label with the lowest
 // cumalative distance between features (scaled euclidean).
+// Features with a std dev of 0 are scaled by 1.
 // Output is a string
-// Returns the row index of the nearest neighbor in db
-int nearestNeigborDistance(std::vector<double> targetFeatures,
-	std::string filename,
+// Returns the row index of the nearest neighbor in db,
+// -1 ("Unkown") if no distance could be computed (NaN features)
+int nearestNeigborDistance(const FeatureVector& targetFeatures,
+	const std::string& filename,
+	std::string& outputLabel);
+
+// Closet neighbor classifer against an in-memory db
+int nearestNeigborDistance(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
 	std::string& outputLabel);
 
 // k-nearest neighbor classifer
@@ -44,8 +109,25 @@ int nearestNeigborDistance(std::vector<double> targetFeatures,
 // distance between features (scaled euclidean).
 // Output is a string
 // Returns the row index of the nearest neighbor in db
-int kNearestNeigborDistance(std::vector<double> targetFeatures,
-	std::string filename,
+int kNearestNeigborDistance(const FeatureVector& targetFeatures,
+	const std::string& filename,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel);
+
+// k-nearest neighbor classifer against an in-memory db
+int kNearestNeigborDistance(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel);
+
+// k-nearest neighbor classifer against an in-memory db that also
+// gives the distance to the chosen label, in std devs (the value
+// compared against std_multiplier)
+int kNearestNeigborDistance(const FeatureVector& targetFeatures,
+	const FeatureDB& db,
 	int k,
 	float std_multiplier,
-	std::string& outputLabel);
\ No newline at end of file
+	std::string& outputLabel,
+	double& outputDistance);
@@ -0,0 +1,50 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    featureRecord.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the fixed size feature record.
+			A feature vector is a plain array sized at compile
+			time, so building, copying and storing one never
+			touches the heap, and a db is one contiguous block
+			of records. The schema id says which features the
+			record holds, so a db of other features is rejected.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// Ids of the feature layouts. Bump when features are added,
+// removed or reordered, so old db files are not misread.
+enum FeatureSchema : uint32_t {
+	FEATURE_SCHEMA_NONE = 0,
+	// {percentFilled, hwRatio, hu[0] .. hu[6]}
+	FEATURE_SCHEMA_SHAPE_V1 = 1,
+};
+
+// N features of type T plus the schema they follow.
+// 16 byte aligned, which is what new gives without C++17
+// aligned allocation, so records in a std::vector stay aligned.
+template <int N, typename T>
+struct alignas(16) FeatureRecord {
+	static const int numFeatures = N;
+	typedef T value_type;
+
+	T values[N];
+	uint32_t schemaId;
+
+	T& operator[](int i) { return values[i]; }
+	const T& operator[](int i) const { return values[i]; }
+	int size() const { return N; }
+	T* begin() { return values; }
+	T* end() { return values + N; }
+	const T* begin() const { return values; }
+	const T* end() const { return values + N; }
+};
+
+// the features getFeatures produces
+static const int NUM_SHAPE_FEATURES = 9;
+typedef FeatureRecord<NUM_SHAPE_FEATURES, double> FeatureVector;
@@ -0,0 +1,114 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    frameScheduler.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the frame deadline scheduler.
+			When frames run over the time budget the scheduler
+			steps down a fixed ladder of cheaper quality levels,
+			and back up once there is room again, so latency stays
+			bounded under load instead of growing.
+ */
+
+#include <cstdio>
+#include <algorithm>
+
+#include "frameScheduler.h"
+
+// cheapest last, each level keeps the savings of the one before
+static const QualityLevel QUALITY_LEVELS[NUM_QUALITY_LEVELS] = {
+	// name                 morphology  scale  overlay  classify every
+	{ "full",                2,          1.0,   true,    1 },
+	{ "light clean up",      1,          1.0,   true,    1 },
+	{ "half resolution",     1,          0.5,   true,    1 },
+	{ "no overlay",          1,          0.5,   false,   1 },
+	{ "classify every 3rd",  1,          0.5,   false,   3 },
+};
+
+// weight of the newest frame in the smoothed frame time
+static const double FRAME_TIME_SMOOTHING = 0.2;
+// frames a level is kept before it can change again, long enough
+// for the smoothed time to settle on the new level
+static const int MIN_FRAMES_AT_LEVEL = 10;
+// the level above must be expected to fit this share of the budget
+static const double STEP_UP_MARGIN = 0.8;
+
+const QualityLevel& getQualityLevel(int level) {
+	return QUALITY_LEVELS[std::max(0, std::min(level, NUM_QUALITY_LEVELS - 1))];
+}
+
+FrameScheduler::FrameScheduler(double budgetMs)
+	: budgetMs(budgetMs), level(0), framesAtLevel(0), levelChanges(0), smoothedFrameMs(0),
+	previousLevel(0), previousLevelMs(0)
+{
+	std::fill(stepCostRatio, stepCostRatio + NUM_QUALITY_LEVELS, 0.0);
+	std::fill(levelFrames, levelFrames + NUM_QUALITY_LEVELS, 0);
+	std::fill(stageTotalMs, stageTotalMs + NUM_FRAME_STAGES, 0.0);
+	std::fill(stageCounts, stageCounts + NUM_FRAME_STAGES, 0);
+}
+
+void FrameScheduler::recordStage(FrameStage stage, double ms) {
+	stageTotalMs[stage] += ms;
+	stageCounts[stage]++;
+}
+
+// smooths the frame time and moves at most one level per call
+bool FrameScheduler::endFrame(double frameMs) {
+	smoothedFrameMs = smoothedFrameMs == 0 ? frameMs : smoothedFrameMs + FRAME_TIME_SMOOTHING * (frameMs - smoothedFrameMs);
+	levelFrames[level]++;
+	framesAtLevel++;
+	if (budgetMs <= 0 || framesAtLevel < MIN_FRAMES_AT_LEVEL) {
+		return false;
+	}
+
+	// once settled after a change, note how the two levels compare
+	if (framesAtLevel == MIN_FRAMES_AT_LEVEL && levelChanges > 0 && previousLevelMs > 0) {
+		if (previousLevel == level - 1) {
+			stepCostRatio[level] = smoothedFrameMs / previousLevelMs;
+		}
+		else if (previousLevel == level + 1) {
+			stepCostRatio[previousLevel] = previousLevelMs / smoothedFrameMs;
+		}
+	}
+
+	int newLevel = level;
+	if (smoothedFrameMs > budgetMs) {
+		newLevel = std::min(level + 1, NUM_QUALITY_LEVELS - 1);
+	}
+	else if (level > 0) {
+		// expected time of the level above, assuming it costs
+		// what it did relative to this one when last measured
+		double costRatio = stepCostRatio[level] > 0 ? std::min(stepCostRatio[level], 1.0) : STEP_UP_MARGIN;
+		if (smoothedFrameMs / costRatio < budgetMs * STEP_UP_MARGIN) {
+			newLevel = level - 1;
+		}
+	}
+	if (newLevel == level) {
+		return false;
+	}
+	previousLevel = level;
+	previousLevelMs = smoothedFrameMs;
+	level = newLevel;
+	framesAtLevel = 0;
+	levelChanges++;
+	return true;
+}
+
+void FrameScheduler::printSummary() const {
+	static const char* stageNames[NUM_FRAME_STAGES] = { "segment", "features", "classify", "display" };
+	printf("stage means:");
+	for (int stage = 0; stage < NUM_FRAME_STAGES; stage++) {
+		printf(" %s %.2f ms", stageNames[stage], stageCounts[stage] > 0 ? stageTotalMs[stage] / stageCounts[stage] : 0.0);
+	}
+	printf("\n");
+	if (budgetMs <= 0) {
+		return;
+	}
+	printf("frame budget %.1f ms, %d level changes, frames per level:", budgetMs, levelChanges);
+	for (int i = 0; i < NUM_QUALITY_LEVELS; i++) {
+		printf(" %d (%s) %d", i, QUALITY_LEVELS[i].name, levelFrames[i]);
+		printf(i + 1 < NUM_QUALITY_LEVELS ? "," : "\n");
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    frameScheduler.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the frame deadline scheduler.
+			When frames run over the time budget the scheduler
+			steps down a fixed ladder of cheaper quality levels,
+			and back up once there is room again, so latency stays
+			bounded under load instead of growing.
+ */
+
+#pragma once
+
+// What the video loop does at one quality level.
+// Every level is at least as cheap as the one before it.
+struct QualityLevel {
+	const char* name;
+	// dilate / erode rounds of the clean up (see SegmentationOptions)
+	int morphologyPasses;
+	// segmentation runs on the frame resized by this
+	double segmentationScale;
+	// draw the selected view (bounding box, region map, ...)
+	bool drawOverlay;
+	// classify every Nth frame, others reuse the last label
+	int classifyEvery;
+};
+
+static const int NUM_QUALITY_LEVELS = 5;
+
+// Returns quality level 0 (full quality) to NUM_QUALITY_LEVELS - 1
+const QualityLevel& getQualityLevel(int level);
+
+// Stages of a frame timed by the video loop
+enum FrameStage {
+	STAGE_SEGMENT,
+	STAGE_FEATURES,
+	STAGE_CLASSIFY,
+	STAGE_DISPLAY,
+	NUM_FRAME_STAGES
+};
+
+// Picks the quality level of the next frame from the whole frame time
+// only, stage times are just kept for printSummary. Frame time is
+// smoothed, and a level is kept for a few frames before it is changed
+// again, so a single slow frame does not flip levels.
+// Steps up only when the smoothed time, scaled by what the level above
+// cost relative to this one when both were last measured, fits the budget.
+class FrameScheduler {
+public:
+	// budgetMs <= 0 disables the scheduler, level 0 is always used
+	explicit FrameScheduler(double budgetMs);
+
+	// level and settings for the next frame
+	int levelIndex() const { return level; }
+	const QualityLevel& qualityLevel() const { return getQualityLevel(level); }
+
+	// time taken by a stage of the current frame, reported in the
+	// summary, it does not affect the level
+	void recordStage(FrameStage stage, double ms);
+	// whole frame time, call once per frame after its stages.
+	// Returns true if the level changed.
+	bool endFrame(double frameMs);
+
+	double budget() const { return budgetMs; }
+	double smoothedFrameTime() const { return smoothedFrameMs; }
+
+	// Prints mean stage times, frames per level and number of level changes
+	void printSummary() const;
+
+private:
+	double budgetMs;
+	int level;
+	int framesAtLevel;
+	int levelChanges;
+	double smoothedFrameMs;
+	// level before the last change, and its smoothed frame time then
+	int previousLevel;
+	double previousLevelMs;
+	// frame time of level i over level i - 1, measured around the
+	// last change between them, 0 if never measured
+	double stepCostRatio[NUM_QUALITY_LEVELS];
+	int levelFrames[NUM_QUALITY_LEVELS];
+	double stageTotalMs[NUM_FRAME_STAGES];
+	int stageCounts[NUM_FRAME_STAGES];
+};
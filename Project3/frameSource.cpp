@@ -0,0 +1,279 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    frameSource.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the sources of frames for the
+			video pipeline. A camera, a video file, a folder
+			of images or generated frames can all be fed to
+			the same loop, so it can be run without a camera.
+ */
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+#include "frameSource.h"
+#include "sharedMemory.h"
+
+// When fps > 0, sleeps until the next frame is due
+void FrameSource::pace(double fps) {
+	if (fps <= 0) {
+		return;
+	}
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (pacedFrames == 0) {
+		paceStart = now;
+	}
+	std::chrono::steady_clock::time_point due = paceStart
+		+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(pacedFrames / fps));
+	if (due > now) {
+		std::this_thread::sleep_until(due);
+	}
+	pacedFrames++;
+}
+
+/*
+ * Camera
+ */
+CameraFrameSource::CameraFrameSource(int device)
+	: capture(device), device(device)
+{
+}
+
+// reads straight into frame, the capture reuses its buffer
+bool CameraFrameSource::read(cv::Mat& frame) {
+	return capture.read(frame) && !frame.empty();
+}
+
+bool CameraFrameSource::isOpened() const {
+	return capture.isOpened();
+}
+
+std::string CameraFrameSource::name() const {
+	return "camera " + std::to_string(device);
+}
+
+/*
+ * Video file
+ */
+VideoFileFrameSource::VideoFileFrameSource(const std::string& filename, bool realTime)
+	: capture(filename), filename(filename), fps(0)
+{
+	if (realTime && capture.isOpened()) {
+		fps = capture.get(cv::CAP_PROP_FPS);
+	}
+}
+
+bool VideoFileFrameSource::read(cv::Mat& frame) {
+	if (!capture.read(frame) || frame.empty()) {
+		return false;
+	}
+	pace(fps);
+	return true;
+}
+
+bool VideoFileFrameSource::isOpened() const {
+	return capture.isOpened();
+}
+
+std::string VideoFileFrameSource::name() const {
+	return "video " + filename;
+}
+
+/*
+ * Image sequence
+ */
+ImageSequenceFrameSource::ImageSequenceFrameSource(const std::string& imageDir, double fps, bool loop)
+	: imageDir(imageDir), fps(fps), loop(loop), nextImage(0)
+{
+	std::vector<cv::String> paths;
+	cv::glob(imageDir, paths, false);
+	std::sort(paths.begin(), paths.end());
+	for (const cv::String& path : paths) {
+		cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+		if (!image.empty()) {
+			images.push_back(image);
+		}
+	}
+}
+
+// hands out the preloaded image, no copy is made
+bool ImageSequenceFrameSource::read(cv::Mat& frame) {
+	if (images.empty()) {
+		return false;
+	}
+	if (nextImage == images.size()) {
+		if (!loop) {
+			return false;
+		}
+		nextImage = 0;
+	}
+	frame = images[nextImage++];
+	pace(fps);
+	return true;
+}
+
+bool ImageSequenceFrameSource::isOpened() const {
+	return !images.empty();
+}
+
+std::string ImageSequenceFrameSource::name() const {
+	return "images " + imageDir;
+}
+
+/*
+ * Synthetic
+ */
+SyntheticFrameSource::SyntheticFrameSource(cv::Size size, int numBlobs, double noiseStdDev, unsigned int seed)
+	: size(size), noiseStdDev(noiseStdDev), rng(seed)
+{
+	// blobs span roughly 5 - 20% of the smaller side
+	int minSide = std::min(size.width, size.height);
+	for (int i = 0; i < numBlobs; i++) {
+		Blob blob;
+		blob.center = cv::Point2f((float)rng.uniform(0.0, (double)size.width), (float)rng.uniform(0.0, (double)size.height));
+		blob.velocity = cv::Point2f((float)rng.uniform(-3.0, 3.0), (float)rng.uniform(-3.0, 3.0));
+		blob.axes = cv::Size(std::max(2, rng.uniform(minSide / 20, minSide / 5 + 1)),
+			std::max(2, rng.uniform(minSide / 20, minSide / 5 + 1)));
+		blob.angle = rng.uniform(0.0, 180.0);
+		blob.spin = rng.uniform(-2.0, 2.0);
+		blob.shade = rng.uniform(0, 60);
+		blob.isEllipse = rng.uniform(0, 2) == 0;
+		blobs.push_back(blob);
+	}
+	canvas.create(size, CV_8UC3);
+	if (noiseStdDev > 0) {
+		noise.create(size, CV_16SC3);
+	}
+}
+
+// renders the next frame into the reused canvas
+bool SyntheticFrameSource::read(cv::Mat& frame) {
+	canvas.setTo(cv::Scalar(200, 200, 200));
+	for (Blob& blob : blobs) {
+		cv::Scalar color(blob.shade, blob.shade, blob.shade);
+		if (blob.isEllipse) {
+			cv::ellipse(canvas, blob.center, blob.axes, blob.angle, 0, 360, color, cv::FILLED);
+		}
+		else {
+			cv::RotatedRect rect(blob.center, cv::Size2f((float)blob.axes.width * 2, (float)blob.axes.height * 2), (float)blob.angle);
+			cv::Point2f corners[4];
+			rect.points(corners);
+			std::vector<cv::Point> polygon(corners, corners + 4);
+			cv::fillConvexPoly(canvas, polygon, color);
+		}
+
+		// drift for the next frame, wrapping at the edges
+		blob.center += blob.velocity;
+		blob.center.x = fmodf(blob.center.x + size.width, (float)size.width);
+		blob.center.y = fmodf(blob.center.y + size.height, (float)size.height);
+		blob.angle += blob.spin;
+	}
+	if (noiseStdDev > 0) {
+		cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(noiseStdDev));
+		cv::add(canvas, noise, canvas, cv::noArray(), CV_8U);
+	}
+	frame = canvas;
+	return true;
+}
+
+bool SyntheticFrameSource::isOpened() const {
+	return size.width > 0 && size.height > 0;
+}
+
+std::string SyntheticFrameSource::name() const {
+	return "synthetic " + std::to_string(size.width) + "x" + std::to_string(size.height)
+		+ ", " + std::to_string(blobs.size()) + " blobs";
+}
+
+// splits off the text after the last ':' if it is a number.
+// Returns false (and leaves text alone) otherwise.
+static bool splitTrailingNumber(std::string& text, double& number) {
+	size_t colon = text.find_last_of(':');
+	if (colon == std::string::npos) {
+		return false;
+	}
+	std::string tail = text.substr(colon + 1);
+	char* end = NULL;
+	double value = strtod(tail.c_str(), &end);
+	if (tail.empty() || *end != '\0') {
+		return false;
+	}
+	number = value;
+	text = text.substr(0, colon);
+	return true;
+}
+
+// splits off ":<option>" from the end of text if present
+static bool splitTrailingOption(std::string& text, const std::string& option) {
+	std::string suffix = ":" + option;
+	if (text.size() > suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0) {
+		text = text.substr(0, text.size() - suffix.size());
+		return true;
+	}
+	return false;
+}
+
+// Creates a frame source from a description.
+// Options are parsed from the end, so file names may contain ':'.
+std::unique_ptr<FrameSource> createFrameSource(const std::string& description) {
+	size_t colon = description.find(':');
+	std::string kind = description.substr(0, colon);
+	std::string args = colon == std::string::npos ? "" : description.substr(colon + 1);
+
+	if (kind == "camera") {
+		int device = args.empty() ? 0 : atoi(args.c_str());
+		return std::unique_ptr<FrameSource>(new CameraFrameSource(device));
+	}
+	else if (kind == "video" && !args.empty()) {
+		bool realTime = splitTrailingOption(args, "realtime");
+		return std::unique_ptr<FrameSource>(new VideoFileFrameSource(args, realTime));
+	}
+	else if (kind == "images" && !args.empty()) {
+		bool loop = splitTrailingOption(args, "loop");
+		double fps = 0;
+		splitTrailingNumber(args, fps);
+		return std::unique_ptr<FrameSource>(new ImageSequenceFrameSource(args, fps, loop));
+	}
+	else if (kind == "shm" && !args.empty()) {
+		bool latestOnly = splitTrailingOption(args, "latest");
+		double numSlots = 4;
+		std::string ringName = args.substr(0, args.find(':'));
+		std::string geometry = args.find(':') == std::string::npos ? "" : args.substr(args.find(':') + 1);
+		splitTrailingNumber(geometry, numSlots);
+		int width, height;
+		if (sscanf(geometry.c_str(), "%dx%d", &width, &height) != 2) {
+			return nullptr;
+		}
+		return std::unique_ptr<FrameSource>(new SharedMemoryFrameSource(ringName, cv::Size(width, height),
+			CV_8UC3, (int)numSlots, latestOnly));
+	}
+	else if (kind == "synthetic") {
+		int width = 1280, height = 720, numBlobs = 3;
+		double noiseStdDev = 8;
+		std::string sizeArg = args.substr(0, args.find(':'));
+		if (!sizeArg.empty() && sscanf(sizeArg.c_str(), "%dx%d", &width, &height) != 2) {
+			return nullptr;
+		}
+		std::string rest = args.find(':') == std::string::npos ? "" : args.substr(args.find(':') + 1);
+		if (!rest.empty()) {
+			numBlobs = atoi(rest.c_str());
+			if (rest.find(':') != std::string::npos) {
+				noiseStdDev = atof(rest.substr(rest.find(':') + 1).c_str());
+			}
+		}
+		return std::unique_ptr<FrameSource>(new SyntheticFrameSource(cv::Size(width, height), numBlobs, noiseStdDev));
+	}
+	return nullptr;
+}
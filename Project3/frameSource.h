@@ -0,0 +1,157 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    frameSource.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the sources of frames for the
+			video pipeline. A camera, a video file, a folder
+			of images or generated frames can all be fed to
+			the same loop, so it can be run without a camera.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+// Result of FrameSource::readFor
+enum FrameReadStatus {
+	FRAME_READ,    // frame holds the next frame
+	FRAME_TIMEOUT, // no frame yet, try again
+	FRAME_END,     // there are no more frames
+};
+
+// Interface for anything that produces frames for the pipeline.
+class FrameSource {
+public:
+	virtual ~FrameSource() {}
+
+	// Gets the next BGR frame. The frame may share memory with
+	// the source (no copy is made), so it is only valid until
+	// the next call to read.
+	// Returns false when there are no more frames.
+	virtual bool read(cv::Mat& frame) = 0;
+
+	// read that waits at most timeoutMs for a frame, so the caller
+	// can stop while a producer is stalled. Sources that never wait
+	// long for a frame just read.
+	virtual FrameReadStatus readFor(cv::Mat& frame, int timeoutMs) { return read(frame) ? FRAME_READ : FRAME_END; }
+
+	// Returns false if the source could not be opened
+	virtual bool isOpened() const = 0;
+
+	// name shown in output
+	virtual std::string name() const = 0;
+
+	// Time the last frame was captured, in ns since the unix epoch,
+	// for sources that know it. Returns false otherwise.
+	virtual bool frameTimestamp(long long& timestampNs) const { return false; }
+
+	// Sequence number the producer gave the last frame, for sources
+	// that know it. Returns false otherwise.
+	virtual bool frameSequence(unsigned long long& sequence) const { return false; }
+
+protected:
+	// When fps > 0, sleeps until the next frame is due so
+	// frames are handed out at real-time pace.
+	void pace(double fps);
+
+private:
+	std::chrono::steady_clock::time_point paceStart;
+	long long pacedFrames = 0;
+};
+
+// Frames from a camera
+class CameraFrameSource : public FrameSource {
+public:
+	explicit CameraFrameSource(int device);
+	bool read(cv::Mat& frame) override;
+	bool isOpened() const override;
+	std::string name() const override;
+
+private:
+	cv::VideoCapture capture;
+	int device;
+};
+
+// Frames from a video file.
+// realTime replays at the fps of the file, otherwise as fast as possible.
+class VideoFileFrameSource : public FrameSource {
+public:
+	VideoFileFrameSource(const std::string& filename, bool realTime);
+	bool read(cv::Mat& frame) override;
+	bool isOpened() const override;
+	std::string name() const override;
+
+private:
+	cv::VideoCapture capture;
+	std::string filename;
+	double fps;
+};
+
+// Frames from every image in a folder, in file name order.
+// Images are loaded up front so replay is not limited by disk.
+// fps > 0 replays at that rate, otherwise as fast as possible.
+// loop restarts from the first image instead of ending.
+class ImageSequenceFrameSource : public FrameSource {
+public:
+	ImageSequenceFrameSource(const std::string& imageDir, double fps, bool loop);
+	bool read(cv::Mat& frame) override;
+	bool isOpened() const override;
+	std::string name() const override;
+
+private:
+	std::vector<cv::Mat> images;
+	std::string imageDir;
+	double fps;
+	bool loop;
+	size_t nextImage;
+};
+
+// Generated frames of numBlobs dark blobs drifting over a light
+// background, with gaussian noise of noiseStdDev grey levels.
+// The same seed always gives the same frames.
+class SyntheticFrameSource : public FrameSource {
+public:
+	SyntheticFrameSource(cv::Size size, int numBlobs, double noiseStdDev, unsigned int seed = 0);
+	bool read(cv::Mat& frame) override;
+	bool isOpened() const override;
+	std::string name() const override;
+
+private:
+	struct Blob {
+		cv::Point2f center;
+		cv::Point2f velocity;
+		cv::Size axes;
+		double angle;
+		double spin;
+		int shade;
+		bool isEllipse;
+	};
+
+	cv::Size size;
+	double noiseStdDev;
+	cv::RNG rng;
+	std::vector<Blob> blobs;
+	// buffers reused every frame
+	cv::Mat canvas;
+	cv::Mat noise;
+};
+
+// Creates a frame source from a description:
+//	camera[:device]                      camera, device 0 by default
+//	video:<file>[:realtime]              video file
+//	images:<folder>[:fps[:loop]]         folder of images, fps 0 = as fast as possible
+//	synthetic[:WxH[:blobs[:noise]]]      generated frames, 1280x720, 3 blobs, noise 8 by default
+//	shm:<name>:WxH[:slots][:latest]      BGR frames from a shared memory ring written by
+//	                                     another process, 4 slots by default. latest skips
+//	                                     to the newest frame when behind (see sharedMemory.h)
+// Returns null if the description is not understood.
+std::unique_ptr<FrameSource> createFrameSource(const std::string& description);
@@ -26,8 +26,205 @@
 #include <queue>
 #include <math.h>
 #include <fstream>
+#include <algorithm>
+#include <array>
+#include <vector>
 
 #include "imageProcessing.h"
+#include "threadPool.h"
+#include "regionBoundary.h"
+
+// segmentFrame works on strips of rows sized so a strip of the frame,
+// its blurred copy and its grayscale rows (7 bytes a pixel) stay in
+// L2 cache. Half of a small L2, so the rest of the working set fits too.
+static const int STRIP_CACHE_BYTES = 512 * 1024;
+static const int STRIP_BYTES_PER_PIXEL = 7;
+static const int MIN_STRIP_ROWS = 16;
+// rows the 5x5 blur reads above and below a strip
+static const int BLUR_RADIUS = 2;
+
+// one dilate or erode of the clean up
+struct CleanUpStep {
+	bool dilate;
+	int radius;
+};
+
+// masks of one band of rows of segmentFrame, labelled within the band
+struct SegmentationBand {
+	RLEMask thresholdMask;
+	RLEMask cleanedMask;
+};
+
+// runs the clean up steps in order on mask. dilateRLE and erodeRLE
+// may write over their input, so all but the first run in place.
+static void cleanUp(const RLEMask& mask, const std::vector<CleanUpStep>& steps, RLEMask& cleaned) {
+	if (steps.empty()) {
+		cleaned = mask;
+		return;
+	}
+	const RLEMask* stepInput = &mask;
+	for (const CleanUpStep& step : steps) {
+		if (step.dilate) {
+			dilateRLE(*stepInput, cleaned, step.radius);
+		}
+		else {
+			erodeRLE(*stepInput, cleaned, step.radius);
+		}
+		stepInput = &cleaned;
+	}
+}
+
+ // Runs the segmentation used by the live video feed on a BGR frame:
+ // blur, grayscale, otsu or adaptive threshold, morphology clean up,
+ // region labelling and filtering to the largest region.
+ // Returns the ID of the largest region, 0 if there is no region.
+int segmentFrame(const cv::Mat& frame, SegmentationResult& result, const SegmentationOptions& options)
+{
+	// segment a smaller copy when asked to, with the
+	// clean up and adaptive window scaled to match
+	double scale = std::min(std::max(options.scale, 0.1), 1.0);
+	cv::Mat resized;
+	const cv::Mat* input = &frame;
+	if (scale < 1.0) {
+		cv::resize(frame, resized, cv::Size(), scale, scale, cv::INTER_AREA);
+		input = &resized;
+	}
+	auto scaleRadius = [scale](int radius) {
+		return std::max(1, static_cast<int>(lround(radius * scale)));
+	};
+	int rows = input->rows;
+	int cols = input->cols;
+	bool adaptive = options.thresholdMethod == THRESHOLD_ADAPTIVE;
+
+	// clean up steps, a cleaned row depends on the
+	// threshold rows up to the sum of their radii away
+	std::vector<CleanUpStep> cleanUpSteps;
+	if (options.morphologyPasses >= 2) {
+		cleanUpSteps = { { true, scaleRadius(4) }, { false, scaleRadius(2) }, { true, scaleRadius(4) }, { false, scaleRadius(6) } };
+	}
+	else if (options.morphologyPasses == 1) {
+		// close only, fills gaps but leaves specks
+		cleanUpSteps = { { true, scaleRadius(4) }, { false, scaleRadius(4) } };
+	}
+	int halo = 0;
+	for (const CleanUpStep& step : cleanUpSteps) {
+		halo += step.radius;
+	}
+
+	ThreadPool& pool = getSharedThreadPool();
+	int stripRows = std::max(MIN_STRIP_ROWS, STRIP_CACHE_BYTES / std::max(1, STRIP_BYTES_PER_PIXEL * cols));
+	int numStrips = (rows + stripRows - 1) / stripRows;
+
+	// blur and grey one strip at a time, while the strip is in cache.
+	// Only the grayscale image goes back to memory.
+	cv::Mat grayscale(rows, cols, CV_8UC1);
+	std::vector<std::array<int, 256>> histograms(adaptive ? 0 : numStrips);
+	pool.parallelFor(numStrips, [&](int firstStrip, int endStrip, int) {
+		cv::Mat blurred;
+		for (int strip = firstStrip; strip < endStrip; strip++) {
+			int rowBegin = strip * stripRows;
+			int rowEnd = std::min(rowBegin + stripRows, rows);
+			// the strip and the rows the blur reads around it, as an
+			// image of its own so the blur takes the same (bit exact)
+			// path as on the whole frame
+			int haloBegin = std::max(rowBegin - BLUR_RADIUS, 0);
+			int haloEnd = std::min(rowEnd + BLUR_RADIUS, rows);
+			cv::Mat stripInput(haloEnd - haloBegin, cols, input->type(),
+				const_cast<uchar*>(input->ptr(haloBegin)), input->step);
+			cv::GaussianBlur(stripInput, blurred, cv::Size(5, 5), 6, 6);
+
+			cv::Mat grayStrip = grayscale.rowRange(rowBegin, rowEnd);
+			cv::cvtColor(blurred.rowRange(rowBegin - haloBegin, rowEnd - haloBegin), grayStrip, cv::COLOR_BGR2GRAY);
+			if (!adaptive) {
+				histograms[strip].fill(0);
+				addToHistogram(grayStrip, histograms[strip].data());
+			}
+		}
+	});
+
+	int thresh = 0;
+	if (!adaptive) {
+		int histogram[256] = { 0 };
+		for (const std::array<int, 256>& stripHistogram : histograms) {
+			for (int i = 0; i < 256; i++) {
+				histogram[i] += stripHistogram[i];
+			}
+		}
+		thresh = otsuThreshold(histogram, rows * cols);
+	}
+
+	// threshold, clean up and label a band at a time, each with halo
+	// rows above and below so its cleaned rows are exact. Bands are
+	// at least 4 halos high to keep the repeated halo work small. The
+	// adaptive threshold also sums the window rows around the halo
+	// again for every band, so its bands are at least 8 times both.
+	int bandRows = std::max(stripRows, 4 * halo);
+	if (adaptive) {
+		bandRows = std::max(bandRows, 8 * (halo + scaleRadius(options.adaptiveRadius)));
+	}
+	int numBands = (rows + bandRows - 1) / bandRows;
+	std::vector<SegmentationBand> bands(numBands);
+	pool.parallelFor(numBands, [&](int firstBand, int endBand, int) {
+		RLEMask haloMask, cleanedHaloMask;
+		for (int bandIdx = firstBand; bandIdx < endBand; bandIdx++) {
+			SegmentationBand& band = bands[bandIdx];
+			int rowBegin = bandIdx * bandRows;
+			int rowEnd = std::min(rowBegin + bandRows, rows);
+			int haloBegin = std::max(rowBegin - halo, 0);
+			int haloEnd = std::min(rowEnd + halo, rows);
+
+			// threshold, inverted so the dark object is foreground
+			if (adaptive) {
+				adaptiveThresholdToRLE(grayscale, scaleRadius(options.adaptiveRadius), options.adaptiveOffset,
+					haloBegin, haloEnd, haloMask);
+			}
+			else {
+				thresholdToRLE(grayscale.rowRange(haloBegin, haloEnd), thresh, haloMask);
+			}
+			appendRowsRLE(haloMask, rowBegin - haloBegin, rowEnd - haloBegin, band.thresholdMask);
+
+			// clean up, the halo rows are only there for the band's rows
+			cleanUp(haloMask, cleanUpSteps, cleanedHaloMask);
+			appendRowsRLE(cleanedHaloMask, rowBegin - haloBegin, rowEnd - haloBegin, band.cleanedMask);
+
+			// label regions within the band
+			labelRuns(band.cleanedMask);
+		}
+	});
+
+	// join the bands, and the regions that cross between them
+	result.thresholdMask = RLEMask();
+	result.cleanedMask = RLEMask();
+	std::vector<int> bandStartRows;
+	for (const SegmentationBand& band : bands) {
+		bandStartRows.push_back(result.cleanedMask.rows);
+		appendRowsRLE(band.thresholdMask, 0, band.thresholdMask.rows, result.thresholdMask);
+		appendRowsRLE(band.cleanedMask, 0, band.cleanedMask.rows, result.cleanedMask);
+	}
+	result.numOfRegions = stitchBandLabels(result.cleanedMask, bandStartRows);
+
+	// retain only largest region in image
+	result.largestRegionId = findLargestRegion(result.cleanedMask, result.numOfRegions);
+	extractRegion(result.cleanedMask, result.largestRegionId, result.largestRegion);
+
+	// back to frame size
+	if (scale < 1.0) {
+		RLEMask small;
+		std::swap(small, result.thresholdMask);
+		resizeRLE(small, frame.rows, frame.cols, result.thresholdMask);
+		std::swap(small, result.cleanedMask);
+		resizeRLE(small, frame.rows, frame.cols, result.cleanedMask);
+		std::swap(small, result.largestRegion);
+		resizeRLE(small, frame.rows, frame.cols, result.largestRegion);
+	}
+	return result.largestRegionId;
+}
+
+// Name of a threshold method, for display
+const char* thresholdMethodName(ThresholdMethod method)
+{
+	return method == THRESHOLD_ADAPTIVE ? "adaptive" : "otsu";
+}
 
  // Performs the region growing algorithm on a binary image.
  // Creates a matrix with region labels on each pixel.
@@ -180,72 +377,82 @@ double momentAroundCentralAxis(cv::Mat& src, int foregroundValue, double& angle)
 	return mu22alpha;
 }
 
-// draw axis lines and bounding box on an image
-int drawAxisLinesAndBoundingBox(const cv::Mat& src, cv::Mat& output) {
+// angle of the axis of least central moment from the moments
+static double axisOfLeastMoment(const cv::Moments& moments) {
+	// (central moments, the 1/m00 scaling cancels out)
+	double tempD = moments.mu20 < moments.mu02 ? CV_PI / 2 : 0;
+	return 0.5 * atan(2 * moments.mu11 / (moments.mu20 - moments.mu02)) + tempD;
+}
+
+// Finds the axis of least central moment and the
+// rotated bounding box of a region.
+// Returns status of run, 0 if there is no region.
+int getAxisAndBoundingBox(const cv::Mat& src, cv::Point2d& centroid, double& axisAngle, cv::RotatedRect& boundingBox) {
 	cv::Moments moments = cv::moments(src, true);
+	if (moments.m00 == 0) {
+		return 0;
+	}
 
 	// centers
-	double cx = moments.m10 / moments.m00; // origin
-	double cy = moments.m01 / moments.m00; // origin
+	centroid.x = moments.m10 / moments.m00; // origin
+	centroid.y = moments.m01 / moments.m00; // origin
 
-	// hu moments?
+	// angle of axis of least moment
+	axisAngle = axisOfLeastMoment(moments);
 
-	double mu02 = 0, mu20 = 0, mu11 = 0;
-	// for each pixel
-	for (int i = 0; i < src.rows; i++) {
-		for (int j = 0; j < src.cols; j++) {
-			// if part of region, f(x,y)
-			if (src.at<uchar>(i, j) == 255) {
-				mu02 = mu02 + (i - cy) * (i - cy); // row, y
-				mu20 = mu20 + (j - cx) * (j - cx); // col, x
-				mu11 = mu11 + (i - cy) * (j - cx);
-			}
-		} // for col
-	} // for row
-	mu02 = mu02 / moments.m00;
-	mu20 = mu20 / moments.m00;
-	mu11 = mu11 / moments.m00;
+	// rotated bounding box from the traced outer boundary
+	RegionBoundary boundary;
+	getRegionBoundary(src, 255, boundary);
+	boundingBox = boundary.boundingBox;
+	return 1;
+}
 
-	// angle of axis of least moment
-	double tempD = mu20 < mu02 ? CV_PI / 2 : 0;
-	double alpha = 0.5 * atan(2 * mu11 / (mu20 - mu02)) + tempD;
-	double beta = alpha + CV_PI / 2; // alpha + pi / 2
+// getAxisAndBoundingBox for a region stored as runs.
+int getAxisAndBoundingBox(const RLEMask& region, cv::Point2d& centroid, double& axisAngle, cv::RotatedRect& boundingBox) {
+	cv::Moments moments = getMomentsRLE(region);
+	if (moments.m00 == 0) {
+		return 0;
+	}
+	centroid.x = moments.m10 / moments.m00;
+	centroid.y = moments.m01 / moments.m00;
+	axisAngle = axisOfLeastMoment(moments);
+
+	RegionBoundary boundary;
+	getRegionBoundary(region, boundary);
+	boundingBox = boundary.boundingBox;
+	return 1;
+}
+
+// draw axis lines and bounding box on an image
+int drawAxisLinesAndBoundingBox(const cv::Mat& src, cv::Mat& output) {
+	cv::Mat temp = cv::Mat::zeros(src.size(), CV_8UC3);
+	cv::cvtColor(src, temp, cv::COLOR_GRAY2BGR);
+
+	cv::Point2d centroid;
+	double alpha;
+	cv::RotatedRect rotatedBB;
+	if (!getAxisAndBoundingBox(src, centroid, alpha, rotatedBB)) {
+		// nothing to draw
+		temp.copyTo(output);
+		return 0;
+	}
 	// length of line to draw
 	double l = 300;
 
 	// find points on line
-	cv::Point axisOrigin = cv::Point(cx, cy);
-	cv::Point xAxisEnd = cv::Point(cx + l * cos(alpha), cy + l * sin(alpha));
-	//double yAxisAngle = (CV_PI / 2) - alpha;
-	//cv::Point yAxisEnd = cv::Point(cx + l * cos(yAxisAngle), cy + l * sin(yAxisAngle));
+	cv::Point axisOrigin = cv::Point(centroid.x, centroid.y);
+	cv::Point xAxisEnd = cv::Point(centroid.x + l * cos(alpha), centroid.y + l * sin(alpha));
 
 	// draw line
-	cv::Mat temp = cv::Mat::zeros(src.size(), CV_8UC3);
-	cv::cvtColor(src, temp, cv::COLOR_GRAY2BGR);
 	cv::line(temp, axisOrigin, xAxisEnd, cv::Scalar(255, 0, 255), 2);
-	//cv::line(temp, axisOrigin, yAxisEnd, cv::Scalar(255, 255, 0), 2);
-
-	/* 
-	// find bounding box
-	cv::Mat tempLabels, stats, centroids;
-	cv::connectedComponentsWithStats(src, tempLabels, stats, centroids); // input image should be 1
-	int leftmostX = stats.at<int>(cv::Point(cv::CC_STAT_LEFT, 1));
-	int topmostY = stats.at<int>(cv::Point(cv::CC_STAT_TOP, 1));
-	int width = stats.at<int>(cv::Point(cv::CC_STAT_WIDTH, 1));
-	int height = stats.at<int>(cv::Point(cv::CC_STAT_HEIGHT, 1));
-	*/
-
-	// find rotated bounding box points	
-	std::vector<cv::Point> regionPoints;
-	cv::findNonZero(src, regionPoints);
-	cv::RotatedRect rotatedBB = cv::minAreaRect(regionPoints);
+
+	// draw box with lines
 	cv::Point2f rect_points[4];
 	rotatedBB.points(rect_points);
-	// draw box with lines
 	for (int j = 0; j < 4; j++) {
 		line(temp, rect_points[j], rect_points[(j + 1) % 4], cv::Scalar(255, 0, 255));
 	}
 
 	temp.copyTo(output);
 	return 1;
-}
\ No newline at end of file
+}
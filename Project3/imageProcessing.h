@@ -12,8 +12,63 @@
 			and the drawing axis and boundary box.
  */
 
+#pragma once
+
 #include <opencv2/core.hpp>
 
+#include "rleMask.h"
+
+// Every mask produced by segmentFrame, kept as runs so the
+// video loop can expand any step of the pipeline for display.
+struct SegmentationResult {
+	RLEMask thresholdMask;
+	RLEMask cleanedMask;   // labelled, run.label is the region id
+	int numOfRegions;
+	RLEMask largestRegion; // runs of the largest region only
+	int largestRegionId;
+};
+
+// How segmentFrame picks foreground pixels
+enum ThresholdMethod {
+	THRESHOLD_OTSU,     // one threshold for the whole frame
+	THRESHOLD_ADAPTIVE, // mean of the window around each pixel, copes with uneven lighting
+};
+
+// Settings of segmentFrame, the defaults are what the video feed uses
+struct SegmentationOptions {
+	ThresholdMethod thresholdMethod = THRESHOLD_OTSU;
+	// adaptive window is (2 * adaptiveRadius + 1) square, 22 is blockSize 45
+	int adaptiveRadius = 22;
+	// pixels darker than the window mean minus this are foreground
+	int adaptiveOffset = 6;
+	// clean up rounds, 2 is the full clean up, 1 only closes gaps, 0 none
+	int morphologyPasses = 2;
+	// segment the frame resized by this (<= 1), the masks are scaled
+	// back to the frame size after. Radii are scaled to match.
+	double scale = 1.0;
+};
+
+// Runs the segmentation used by the live video feed on a BGR frame:
+// blur, grayscale, otsu or adaptive threshold, morphology clean up,
+// region labelling and filtering to the largest region.
+// Everything after the grayscale step works on runs (see rleMask.h).
+// The frame is processed in strips of rows on the shared thread pool:
+// blur and grayscale per L2 sized strip, then threshold, clean up and
+// labelling per band with enough rows around it for the clean up, and
+// the band labels are joined at the end. Results are the same as
+// running each step on the whole frame.
+// Params:
+//	frame:   BGR input image
+//	result:  every intermediate mask of the pipeline (Output)
+//	options: threshold method and its settings
+//
+// Returns the ID of the largest region, 0 if there is no region.
+int segmentFrame(const cv::Mat& frame, SegmentationResult& result,
+	const SegmentationOptions& options = SegmentationOptions());
+
+// Name of a threshold method, for display
+const char* thresholdMethodName(ThresholdMethod method);
+
 // Performs the region growing algorithm on a binary image.
 // Creates a matrix with region labels on each pixel.
 // Params:
@@ -48,6 +103,27 @@ int filterOnlylargestRegion(
 // angle is the output for the angle of the axis
 double momentAroundCentralAxis(cv::Mat& src, int foregroundValue, double& angle);
 
+// Finds the axis of least central moment and the
+// rotated bounding box of a region.
+// Params:
+//	src:         binary image with only one region
+//	centroid:    center of mass of the region (Output)
+//	axisAngle:   angle of the axis of least central moment,
+//	             in radians (Output)
+//	boundingBox: rotated bounding box of the region (Output)
+//
+// Returns status of run, 0 if there is no region.
+int getAxisAndBoundingBox(const cv::Mat& src,
+	cv::Point2d& centroid,
+	double& axisAngle,
+	cv::RotatedRect& boundingBox);
+
+// getAxisAndBoundingBox for a region stored as runs
+int getAxisAndBoundingBox(const RLEMask& region,
+	cv::Point2d& centroid,
+	double& axisAngle,
+	cv::RotatedRect& boundingBox);
+
 // draw axis lines and bounding box on an image
 // Params:
 //	src:	Address of source binary image. Image should
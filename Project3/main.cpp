@@ -18,16 +18,176 @@
 #include <cstring>
 #include <cstdio>
 #include <string>
+#include <vector>
 #include <cstdlib>
+#include <memory>
 
 #include "imageProcessing.h"
 #include "driverFunctions.h"
 #include "featureExtraction.h"
+#include "frameSource.h"
+#include "sharedMemory.h"
+#include "verification.h"
+#include "evaluation.h"
 
 // *** Main ***
+// Usage:
+//   Project3 [--source <source>] [--headless] [--frames <n>]
+//            [--publish-shm <name>] [--publish-socket <path>]
+//            [--threshold otsu|adaptive] [--budget <ms>]
+//            [--cache <entries>] [--cache-grid <stddevs>]
+//            [--k <k>] [--std-multiplier <m>] [--streams <n>]
+//                                       run the video pipeline, on camera 0
+//                                       unless a source is given (see
+//                                       createFrameSource for the formats),
+//                                       optionally publishing every result
+//                                       (see sharedMemory.h), lowering quality
+//                                       when frames take over the budget
+//                                       (see frameScheduler.h), and caching
+//                                       classifications (classificationCache.h)
+//                                       with the given kNN settings.
+//                                       --source can be given several times,
+//                                       or --streams runs n copies of the
+//                                       source, to run one pipeline per
+//                                       source on its own thread
+//   Project3 --bench-threshold [--source <source>] [--frames <n>]
+//                                       time otsu against adaptive threshold,
+//                                       on synthetic frames unless a source
+//                                       is given
+//   Project3 --image <path> [--threshold otsu|adaptive]
+//                                       show every segmentation step of one
+//                                       image
+//   Project3 --train <imageDir> [--augment]
+//                                       add labelled images in
+//                                       imageDir/<label>/ to db.txt
+//   Project3 --evaluate <dbFile> [<maxK>]
+//                                       leave one out accuracy of the db for
+//                                       k = 1..maxK (default 5) and a range of
+//                                       std multipliers, to evaluation.csv
+//   Project3 --verify [--full]          compare the optimized pipeline and
+//                                       classifiers with the reference copies,
+//                                       timings to verification_scaling.csv
 int main(int argc, char** argv)
 {
-    executeVideoFeed();
+    if (argc >= 3 && strcmp(argv[1], "--train") == 0) {
+        bool augment = argc >= 4 && strcmp(argv[3], "--augment") == 0;
+        return executeBulkTraining(argv[2], "db.txt", augment) < 0 ? 1 : 0;
+    }
+    if (argc >= 3 && strcmp(argv[1], "--evaluate") == 0) {
+        int maxK = argc >= 4 ? atoi(argv[3]) : 5;
+        VideoFeedOptions defaults;
+        return executeEvaluation(argv[2], maxK, defaults.knnK, defaults.stdMultiplier, "evaluation.csv") < 0 ? 1 : 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--verify") == 0) {
+        bool full = argc >= 3 && strcmp(argv[2], "--full") == 0;
+        return executeVerification(full, "verification_scaling.csv") != 0 ? 1 : 0;
+    }
 
-    return 0;
+    std::vector<std::string> sourceDescriptions;
+    int numStreams = 1;
+    std::string publishSharedMemory, publishSocket;
+    bool benchThreshold = false;
+    std::string imagePath;
+    VideoFeedOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+            sourceDescriptions.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.maxFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--publish-shm") == 0 && i + 1 < argc) {
+            publishSharedMemory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--publish-socket") == 0 && i + 1 < argc) {
+            publishSocket = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            std::string method = argv[++i];
+            if (method != "otsu" && method != "adaptive") {
+                printf("Unknown threshold method %s\n", method.c_str());
+                return 1;
+            }
+            options.segmentation.thresholdMethod = method == "adaptive" ? THRESHOLD_ADAPTIVE : THRESHOLD_OTSU;
+        }
+        else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            options.frameBudgetMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            options.classificationCacheSize = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--cache-grid") == 0 && i + 1 < argc) {
+            options.classificationCacheGrid = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--k") == 0 && i + 1 < argc) {
+            options.knnK = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--std-multiplier") == 0 && i + 1 < argc) {
+            options.stdMultiplier = static_cast<float>(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--streams") == 0 && i + 1 < argc) {
+            numStreams = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            imagePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--bench-threshold") == 0) {
+            benchThreshold = true;
+        }
+        else {
+            printf("Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (!imagePath.empty()) {
+        cv::Mat image = cv::imread(imagePath);
+        if (image.empty()) {
+            printf("Unable to read %s\n", imagePath.c_str());
+            return 1;
+        }
+        return executeSingleImage(image, options.segmentation) < 0 ? 1 : 0;
+    }
+    if (sourceDescriptions.empty()) {
+        sourceDescriptions.push_back(benchThreshold ? "synthetic" : "camera:0");
+    }
+    // n copies of a single source
+    if (sourceDescriptions.size() == 1 && numStreams > 1) {
+        sourceDescriptions.resize(numStreams, sourceDescriptions[0]);
+    }
+    std::vector<std::unique_ptr<FrameSource>> frameSources;
+    for (const std::string& sourceDescription : sourceDescriptions) {
+        frameSources.push_back(createFrameSource(sourceDescription));
+        if (!frameSources.back()) {
+            printf("Unknown frame source %s\n", sourceDescription.c_str());
+            return 1;
+        }
+    }
+    FrameSource* frameSource = frameSources[0].get();
+    if (benchThreshold) {
+        int numFrames = options.maxFrames > 0 ? options.maxFrames : 200;
+        return executeThresholdBenchmark(*frameSource, numFrames, options.segmentation) < 0 ? 1 : 0;
+    }
+    if (frameSources.size() > 1) {
+        if (!publishSharedMemory.empty() || !publishSocket.empty()) {
+            printf("Results can only be published from a single stream\n");
+            return 1;
+        }
+        std::vector<FrameSource*> streamSources;
+        for (std::unique_ptr<FrameSource>& source : frameSources) {
+            streamSources.push_back(source.get());
+        }
+        return executeMultiStreamFeed(streamSources, options) < 0 ? 1 : 0;
+    }
+    std::unique_ptr<ResultPublisher> resultPublisher;
+    if (!publishSharedMemory.empty() || !publishSocket.empty()) {
+        resultPublisher.reset(new ResultPublisher(publishSharedMemory, publishSocket));
+        options.resultPublisher = resultPublisher.get();
+    }
+    int status = executeVideoFeed(*frameSource, options);
+
+    return status < 0 ? 1 : 0;
 }
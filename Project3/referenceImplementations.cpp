@@ -0,0 +1,378 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    referenceImplementations.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains frozen copies of the original
+			segmentation, feature and classifier functions.
+			They are only used by the verification run (see
+			verification.h) to check that the optimized paths
+			still give the same results. Do not optimize these.
+ */
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cstdio>
+#include <string>
+#include <queue>
+#include <set>
+#include <math.h>
+#include <algorithm>
+#include <cfloat>
+
+#include "referenceImplementations.h"
+
+// frozen copy of regionGrowing
+int referenceRegionGrowing(cv::Mat& src, cv::Mat& regionIdImage, int foregroundValue)
+{
+	// init queue, label, regionIdImage
+	std::queue<cv::Point> q;
+	int currId = 1;
+    regionIdImage = cv::Mat::zeros(src.size(), CV_32SC1);
+
+    // init offset to get neighbors
+	// TODO: Parameterize connectedness
+	// 4-con
+    //int dx[4] = {0, -1, 1, 0};
+    //int dy[4] = {-1, 0, 0, 1};
+    //int numNeighbors = 4;
+	// 8-con
+	int dx[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	int dy[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+	int numNeighbors = 8;
+
+    // for each pixel
+    for (int i = 0; i < src.rows; i++) {
+		//cv::Vec3b* srcRptr = src.ptr<cv::Vec3b>(i);
+		//cv::Vec3b* regionRptr = regionIdImage.ptr<cv::Vec3b>(i);
+        for (int j = 0; j < src.cols; j++) {
+            // if pixel is foreground and unlablled
+            if (src.at<uchar>(i, j) == foregroundValue && regionIdImage.at<int>(i, j) == 0) {
+                q.push(cv::Point(j, i));
+				// label
+                regionIdImage.at<int>(i, j) = currId;
+
+                // while queue not empty (go over connected neigbors)
+                while (!q.empty()) {
+                    cv::Point point = q.front();
+                    q.pop();
+
+                    // for each neighbors of this pixel
+                    for (int k = 0; k < numNeighbors; k++) {
+                        // Compute coordinates of neighbor pixel
+                        int neighborX = point.x + dx[k];
+                        int neighborY = point.y + dy[k];
+
+                        // bounds check
+                        if (neighborX >= 0 
+							&& neighborY >= 0 
+							&& neighborX < src.cols 
+							&& neighborY < src.rows)
+                        {
+                            // If neighbor is foreground and unmarked, add to queue and mark
+                            if (src.at<uchar>(neighborY, neighborX) == foregroundValue 
+								&& regionIdImage.at<int>(neighborY, neighborX) == 0)
+                            {
+                                q.push(cv::Point(neighborX, neighborY));
+                                regionIdImage.at<int>(neighborY, neighborX) = currId;
+                            } // if neighbor is fg and unlabelled
+                        } // if bounds check
+                    } // for neighbors
+                } // while queue
+                currId++;
+            } // if pixel is fg and unlabelled
+        } // for cols
+    } // for rows
+    return currId - 1;
+}
+
+// frozen copy of filterOnlylargestRegion
+int referenceFilterOnlylargestRegion(cv::Mat& src, cv::Mat& regionIdImage, cv::Mat& largestRegionMask, int numOfRegions)
+{
+	int largestLabel = 0;
+	int largestArea = 0;
+	for (int i = 1; i <= numOfRegions; i++)
+	{
+		// create binary mask for current region
+		cv::Mat mask = regionIdImage == i;
+
+		// calculate area of region
+		int area = cv::countNonZero(mask);
+
+		// check if region is larger than previous largest region
+		if (area > largestArea) {
+			largestLabel = i;
+			largestArea = area;
+		}
+	}
+	// create binary mask for largest component
+	largestRegionMask = regionIdImage == largestLabel;
+	return largestLabel;
+}
+
+// The original video loop pipeline
+int referenceSegmentFrame(const cv::Mat& frame,
+	cv::Mat& thresholdImage,
+	cv::Mat& cleanedImage,
+	cv::Mat& labelMap,
+	int& numOfRegions,
+	cv::Mat& largestRegionImage)
+{
+	// blur
+	cv::Mat blurTarget;
+	cv::GaussianBlur(frame, blurTarget, cv::Size(5, 5), 6, 6);
+
+	// grey
+	cv::Mat grayscale;
+	cv::cvtColor(blurTarget, grayscale, cv::COLOR_BGR2GRAY);
+
+	// threshold
+	cv::Mat otsuThresholdImg;
+	cv::threshold(grayscale, otsuThresholdImg, 0, 255, cv::THRESH_OTSU);
+	cv::bitwise_not(otsuThresholdImg, thresholdImage);
+
+	// clean up
+	cv::Mat erodeImg, dilateImg;
+	cv::dilate(thresholdImage, dilateImg, cv::Mat(), cv::Point(-1, -1), 4);
+	cv::erode(dilateImg, erodeImg, cv::Mat(), cv::Point(-1, -1), 2);
+	cv::dilate(erodeImg, dilateImg, cv::Mat(), cv::Point(-1, -1), 4);
+	cv::erode(dilateImg, cleanedImage, cv::Mat(), cv::Point(-1, -1), 6);
+
+	// create labelMap
+	numOfRegions = referenceRegionGrowing(cleanedImage, labelMap, 255);
+
+	// retain only largest region in image
+	return referenceFilterOnlylargestRegion(cleanedImage, labelMap, largestRegionImage, numOfRegions);
+}
+
+// frozen copy of getFeatures
+int referenceGetFeatures(const cv::Mat& src, std::vector<double>& featureVector) {
+
+	// reset vector
+	featureVector.clear();
+
+	// Moment around central axis 
+	cv::Moments moments = cv::moments(src, true);
+	double hu[7];
+	cv::HuMoments(moments, hu);
+
+	// find rotated bounding box points	
+	std::vector<cv::Point> regionPoints;
+	cv::findNonZero(src, regionPoints);
+	cv::RotatedRect rotatedBB = cv::minAreaRect(regionPoints);
+
+	// calculate the area of the rotated bounding box
+	double width = rotatedBB.size.width;
+	double height = rotatedBB.size.height;
+	double theta = rotatedBB.angle * CV_PI / 180.0; // convert angle from degrees to radians
+	if (theta < -CV_PI / 2) { // adjust angle to be in range (-pi/2, pi/2)
+		theta += CV_PI;
+	}
+	else if (theta > CV_PI / 2) {
+		theta -= CV_PI;
+	}
+	double rotatedWidth = fabs(width * cos(theta)) + fabs(height * sin(theta));
+	double rotatedHeight = fabs(width * sin(theta)) + fabs(height * cos(theta));
+	double rotatedArea = rotatedWidth * rotatedHeight;
+
+	// h/w ratio
+	double hwRatio = std::max(rotatedHeight, rotatedWidth) / std::min(rotatedHeight, rotatedWidth);
+	// percentage filled
+	int regionArea = cv::countNonZero(src);
+	double percentFilled = static_cast<double>(regionArea) / rotatedArea * 100.0;
+
+	// add to vector
+	featureVector.push_back(percentFilled);
+	featureVector.push_back(hwRatio);
+	for (int i = 0; i < 7; i++) {
+		featureVector.push_back(hu[i]);
+	}
+	return 1;
+}
+
+// frozen copy of getStandardDeviation
+int referenceGetStandardDeviation(std::vector<std::vector<double>> allFeatures, std::vector<double> &stdDeviations) {
+
+	// reset stdDeviations vector
+	stdDeviations.clear();
+
+	// find mean
+	std::vector<double> means;
+	// for each feature in a feature vector
+	for (int featureIdx = 0; featureIdx < allFeatures[0].size(); featureIdx++) {
+		double sum = 0, mean = 0;
+		// for each feature vector in all features
+		for (int allFeaturesIdx = 0; allFeaturesIdx < allFeatures.size(); allFeaturesIdx++) {
+			sum = sum + allFeatures[allFeaturesIdx][featureIdx];
+		}
+		mean = sum / allFeatures.size();
+		means.push_back(mean);
+	}
+
+	// find std dev
+	// for each feature in a feature vector
+	for (int featureIdx = 0; featureIdx < allFeatures[0].size(); featureIdx++) {
+		double sum = 0;
+		// for each feature vector in all features
+		for (int allFeaturesIdx = 0; allFeaturesIdx < allFeatures.size(); allFeaturesIdx++) {
+			double diff = allFeatures[allFeaturesIdx][featureIdx] - means[featureIdx];
+			sum = sum + diff*diff;
+		}
+		double stdDev = sqrt(sum / allFeatures.size());
+		stdDeviations.push_back(stdDev);
+	}
+	//for (int i = 0; i < stdDeviations.size(); i++) {
+	//	printf("mean[%d]: %f; ", i, means[i]);
+	//}
+	//printf("\n");
+	//for (int i = 0; i < stdDeviations.size(); i++) {
+	//	printf("Stddev[%d]: %f; ", i, stdDeviations[i]);
+	//}
+	//printf("\n");
+	//for (int i = 0; i < labels.size(); i++) {
+	//	printf("labels[%d]: %s; ", i, labels[i].c_str());
+	//}
+	return 1;	
+}
+
+// frozen copy of nearestNeigborDistance, db passed in
+int referenceNearestNeigborDistance(std::vector<double> targetFeatures,
+	const std::vector<std::vector<double>>& allFeatures,
+	const std::vector<std::string>& labels,
+	std::string& outputLabel)
+{
+	// edge cases
+	if (labels.size() == 1) {
+		outputLabel = labels[0];
+		return 1;
+	}
+	else if (labels.size() == 0) {
+		outputLabel = "No data in db file";
+		return 0;
+	}
+
+	// get std dev
+	std::vector<double> stdDeviations;
+	referenceGetStandardDeviation(allFeatures, stdDeviations);
+
+	double minDistance = DBL_MAX;
+	int nearestNeigborIndex = -1;
+	// for all data points in db
+	for (int i = 0; i < allFeatures.size(); i++) {
+
+		// calculate distance to data point
+		double distanceSum = 0;
+		// for each feature
+		for (int j = 0; j < allFeatures[i].size(); j++) {
+			double distanceScaled = (targetFeatures[j] - allFeatures[i][j])/ stdDeviations[j];
+			double distanceSquared = distanceScaled * distanceScaled;
+			distanceSum = distanceSum + distanceSquared;
+		} // for features	
+
+		// if distance to data point < minDistance
+		if (distanceSum < minDistance) {
+			nearestNeigborIndex = i;
+			minDistance = distanceSum;
+		} 	
+	} // for db loop
+
+	outputLabel = labels[nearestNeigborIndex];
+	return nearestNeigborIndex;
+}
+
+// frozen copy of kNearestNeigborDistance, db passed in
+int referenceKNearestNeigborDistance(std::vector<double> targetFeatures,
+	const std::vector<std::vector<double>>& allFeatures,
+	const std::vector<std::string>& labels,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel,
+	double& outputDistance)
+{
+	outputDistance = 0;
+	// edge cases
+	if (labels.size() == 1) {
+		outputLabel = labels[0];
+		return 1;
+	}
+	else if (labels.size() == 0) {
+		outputLabel = "No data in db file";
+		return 0;
+	}
+
+	// get std dev
+	std::vector<double> stdDeviations;
+	referenceGetStandardDeviation(allFeatures, stdDeviations);
+
+	// turn labels in a set
+	std::set<std::string> setOfLabels;
+	for (int i = 0; i < labels.size(); i++) {
+		setOfLabels.insert(labels[i]);
+	}
+
+	double minDistance = DBL_MAX;
+	// for every label
+	for (std::string label : setOfLabels) {
+		// create vector of distances to all labels
+		std::vector<double> distances;
+
+		// for every feature vector in db
+		for (int i = 0; i < allFeatures.size(); i++) {
+
+			// if label is label we want
+			if (labels[i] == label) {
+				// calculate the distance to that data point 
+				// (which is the same label as we want)
+				double distanceSum = 0;
+				// for each feature
+				for (int j = 0; j < allFeatures[i].size(); j++) {
+					double distanceScaled = (targetFeatures[j] - allFeatures[i][j]) / stdDeviations[j];
+					double distanceSquared = distanceScaled * distanceScaled;
+					distanceSum = distanceSum + distanceSquared;
+				} // for each feature
+
+				// add distance to that data point to vector of distances
+				distances.push_back(distanceSum);
+			}
+		} // for db loop
+
+		// once we have all distances to this label:
+		// sort vector and take top k
+		std::sort(distances.begin(), distances.end());
+		// sum top k (fewer if the label has less than k rows)
+		double finalDistance = 0;
+		for (int i = 0; i < k && i < distances.size(); i++) {
+			finalDistance = finalDistance + distances[i];
+		}
+
+		// take min final distances amoung all labels
+		if (finalDistance < minDistance) {
+			minDistance = finalDistance;
+			outputLabel = label;
+		} // if
+	} // for each label
+
+
+	/* 
+	* THRESHOLDING
+	* Using the min distance / sum of stdDev
+	* Because min distance is a sum of feature distances
+	*/
+	// Check if distance to nearest neighbor is within std_multiplier standard deviations sum
+	double sumOfStdDev =  0;
+	for (int i = 0; i < stdDeviations.size(); i++) {
+		sumOfStdDev = sumOfStdDev + stdDeviations[i];
+	}
+	float dist_stddev = minDistance / sumOfStdDev;
+	outputDistance = dist_stddev;
+	if (dist_stddev > std_multiplier) {
+		// distance to nearest neighbor is above std_multiplier standard deviations, so prediction is unreliable
+		outputLabel = "Unkown"; 
+		return -1;
+	}
+	return 0;
+
+} // func kNearestNeigborDistance()
@@ -0,0 +1,68 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    referenceImplementations.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains frozen copies of the original
+			segmentation, feature and classifier functions.
+			They are only used by the verification run (see
+			verification.h) to check that the optimized paths
+			still give the same results. Do not optimize these.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// regionGrowing as first written: 8 connected flood fill with a queue.
+// Returns number of regions.
+int referenceRegionGrowing(cv::Mat& src, cv::Mat& regionIdImage, int foregroundValue);
+
+// filterOnlylargestRegion as first written: one mask and count per region.
+// Returns the ID of the region.
+int referenceFilterOnlylargestRegion(cv::Mat& src, cv::Mat& regionIdImage, cv::Mat& largestRegionMask, int numOfRegions);
+
+// The original video loop pipeline: blur, grayscale, otsu threshold
+// with cv::threshold, cv::dilate / cv::erode clean up, region growing
+// and filtering to the largest region, all on full images.
+// Returns the ID of the largest region.
+int referenceSegmentFrame(const cv::Mat& frame,
+	cv::Mat& thresholdImage,
+	cv::Mat& cleanedImage,
+	cv::Mat& labelMap,
+	int& numOfRegions,
+	cv::Mat& largestRegionImage);
+
+// getFeatures as first written: moments of the image and
+// minAreaRect of every region pixel.
+int referenceGetFeatures(const cv::Mat& src, std::vector<double>& featureVector);
+
+// getStandardDeviation as first written
+int referenceGetStandardDeviation(std::vector<std::vector<double>> allFeatures, std::vector<double>& stdDeviations);
+
+// nearestNeigborDistance as first written, on an in-memory db
+// instead of re-reading the file.
+// Returns the row index of the nearest neighbor in db
+int referenceNearestNeigborDistance(std::vector<double> targetFeatures,
+	const std::vector<std::vector<double>>& allFeatures,
+	const std::vector<std::string>& labels,
+	std::string& outputLabel);
+
+// kNearestNeigborDistance as first written, on an in-memory db.
+// Two fixes so results are defined: a label with fewer than k rows sums
+// the rows it has (the original read past the end of the distances),
+// and the function returns 0 for a known label (the original fell off
+// the end). outputDistance is the value compared with std_multiplier.
+// Returns -1 for "Unkown".
+int referenceKNearestNeigborDistance(std::vector<double> targetFeatures,
+	const std::vector<std::vector<double>>& allFeatures,
+	const std::vector<std::string>& labels,
+	int k,
+	float std_multiplier,
+	std::string& outputLabel,
+	double& outputDistance);
@@ -0,0 +1,145 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    regionBoundary.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the boundary tracing of a region.
+			Only the outer boundary pixels are followed, and the
+			convex hull, rotated bounding box and perimeter are
+			computed from them, instead of from every pixel of
+			the region.
+ */
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "regionBoundary.h"
+
+// neighbor offsets, counter clockwise starting east (y points down)
+static const int dx[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int dy[8] = { 0, -1, -1, -1, 0, 1, 1, 1 };
+
+// Follows the boundary from start, the first pixel of the region in
+// raster order, with the 8 connected inner boundary tracing algorithm
+// (Sonka, Hlavac, Boyle). isInside(x, y) tells whether a pixel in the
+// image belongs to the region.
+template <typename IsInside>
+static int followBoundary(cv::Point start, int rows, int cols, IsInside isInside, std::vector<cv::Point>& boundary) {
+	boundary.clear();
+	boundary.push_back(start);
+
+	// start pixel has nothing to its west or above it
+	int dir = 7;
+	cv::Point current = start;
+	for (;;) {
+		// search counter clockwise, starting just past where we came from
+		int searchStart = dir % 2 == 0 ? (dir + 7) % 8 : (dir + 6) % 8;
+		bool found = false;
+		for (int k = 0; k < 8; k++) {
+			int d = (searchStart + k) % 8;
+			int x = current.x + dx[d];
+			int y = current.y + dy[d];
+			if (x >= 0 && y >= 0 && x < cols && y < rows && isInside(x, y)) {
+				current = cv::Point(x, y);
+				dir = d;
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			return 1; // single pixel region
+		}
+		// done once the first step is about to be repeated
+		if (boundary.size() >= 2 && current == boundary[1] && boundary.back() == start) {
+			boundary.pop_back();
+			return static_cast<int>(boundary.size());
+		}
+		boundary.push_back(current);
+	}
+}
+
+// Traces the outer boundary of a region stored as runs.
+// Pixels are looked up with a binary search in the runs of their row.
+int traceOuterBoundary(const RLEMask& region, std::vector<cv::Point>& boundary) {
+	boundary.clear();
+	if (region.runs.empty()) {
+		return 0;
+	}
+	const Run& first = region.runs[0];
+	int label = first.label;
+	auto isInside = [&region, label](int x, int y) {
+		std::vector<Run>::const_iterator rowBegin = region.runs.begin() + region.rowStart[y];
+		std::vector<Run>::const_iterator rowEnd = region.runs.begin() + region.rowStart[y + 1];
+		// last run starting at or before x
+		std::vector<Run>::const_iterator run = std::upper_bound(rowBegin, rowEnd, x,
+			[](int value, const Run& r) { return value < r.start; });
+		if (run == rowBegin) {
+			return false;
+		}
+		--run;
+		return x < run->end && run->label == label;
+	};
+	return followBoundary(cv::Point(first.start, first.row), region.rows, region.cols, isInside, boundary);
+}
+
+// Traces the outer boundary of the first region (in raster order)
+// of pixels equal to foregroundValue in an 8 bit image.
+int traceOuterBoundary(const cv::Mat& src, int foregroundValue, std::vector<cv::Point>& boundary) {
+	boundary.clear();
+	// find the first pixel, stops as soon as it is found
+	cv::Point start(-1, -1);
+	for (int i = 0; i < src.rows && start.x < 0; i++) {
+		const uchar* rptr = src.ptr<uchar>(i);
+		for (int j = 0; j < src.cols; j++) {
+			if (rptr[j] == foregroundValue) {
+				start = cv::Point(j, i);
+				break;
+			}
+		}
+	}
+	if (start.x < 0) {
+		return 0;
+	}
+	auto isInside = [&src, foregroundValue](int x, int y) {
+		return src.ptr<uchar>(y)[x] == foregroundValue;
+	};
+	return followBoundary(start, src.rows, src.cols, isInside, boundary);
+}
+
+// fills in the hull, bounding box and perimeter from the traced points
+static int measureBoundary(RegionBoundary& boundary) {
+	if (boundary.points.empty()) {
+		boundary.hull.clear();
+		boundary.boundingBox = cv::RotatedRect();
+		boundary.perimeter = 0;
+		return 0;
+	}
+	cv::convexHull(boundary.points, boundary.hull);
+	boundary.boundingBox = cv::minAreaRect(boundary.hull);
+
+	// closed chain, so the last point steps back to the first
+	boundary.perimeter = 0;
+	int numPoints = static_cast<int>(boundary.points.size());
+	for (int i = 0; numPoints > 1 && i < numPoints; i++) {
+		cv::Point step = boundary.points[(i + 1) % numPoints] - boundary.points[i];
+		boundary.perimeter += (step.x != 0 && step.y != 0) ? sqrt(2.0) : 1.0;
+	}
+	return 1;
+}
+
+// Traces the boundary and fills in the hull, bounding box and perimeter.
+int getRegionBoundary(const RLEMask& region, RegionBoundary& boundary) {
+	traceOuterBoundary(region, boundary.points);
+	return measureBoundary(boundary);
+}
+
+int getRegionBoundary(const cv::Mat& src, int foregroundValue, RegionBoundary& boundary) {
+	traceOuterBoundary(src, foregroundValue, boundary.points);
+	return measureBoundary(boundary);
+}
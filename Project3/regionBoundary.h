@@ -0,0 +1,50 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    regionBoundary.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the boundary tracing of a region.
+			Only the outer boundary pixels are followed, and the
+			convex hull, rotated bounding box and perimeter are
+			computed from them, instead of from every pixel of
+			the region.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "rleMask.h"
+
+// Outer boundary of a region and the shape measures taken from it
+struct RegionBoundary {
+	// outer boundary pixels in tracing order, 8 connected
+	std::vector<cv::Point> points;
+	// convex hull of the boundary (and so of the region)
+	std::vector<cv::Point> hull;
+	// rotated bounding box of the region
+	cv::RotatedRect boundingBox;
+	// length of the boundary, 1 per straight step and
+	// sqrt(2) per diagonal step
+	double perimeter;
+};
+
+// Traces the outer boundary of a region stored as runs.
+// If the mask holds more than one region, the one containing the
+// first pixel in raster order is traced.
+// Returns number of boundary points, 0 for an empty mask.
+int traceOuterBoundary(const RLEMask& region, std::vector<cv::Point>& boundary);
+
+// Traces the outer boundary of the first region (in raster order)
+// of pixels equal to foregroundValue in an 8 bit image.
+// Returns number of boundary points, 0 if there is no region.
+int traceOuterBoundary(const cv::Mat& src, int foregroundValue, std::vector<cv::Point>& boundary);
+
+// Traces the boundary and fills in the hull, bounding box and perimeter.
+// Returns status of run, 0 if there is no region.
+int getRegionBoundary(const RLEMask& region, RegionBoundary& boundary);
+int getRegionBoundary(const cv::Mat& src, int foregroundValue, RegionBoundary& boundary);
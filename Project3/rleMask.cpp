@@ -0,0 +1,663 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    rleMask.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the run length encoded (RLE) binary
+			masks used by the segmentation. A mask is stored as
+			the horizontal runs of foreground pixels, so clean up,
+			region labelling, area and moments cost in proportion
+			to the number of runs (the object boundary) instead
+			of the number of pixels. Masks are only expanded back
+			to a cv::Mat for display.
+ */
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "rleMask.h"
+
+// starts an empty mask of the given size
+static void resetMask(RLEMask& mask, int rows, int cols) {
+	mask.rows = rows;
+	mask.cols = cols;
+	mask.runs.clear();
+	mask.rowStart.assign(1, 0);
+}
+
+// closes the current row, call once per row in order
+static void endRow(RLEMask& mask) {
+	mask.rowStart.push_back(static_cast<int>(mask.runs.size()));
+}
+
+// Finds the otsu threshold of an 8 bit grayscale image
+// (same algorithm as OpenCV, so the same value is picked)
+int otsuThreshold(const cv::Mat& gray) {
+	int histogram[256] = { 0 };
+	addToHistogram(gray, histogram);
+	return otsuThreshold(histogram, gray.rows * gray.cols);
+}
+
+// Adds the pixels of an 8 bit grayscale image to a 256 bin histogram
+void addToHistogram(const cv::Mat& gray, int histogram[256]) {
+	for (int i = 0; i < gray.rows; i++) {
+		const uchar* rptr = gray.ptr<uchar>(i);
+		for (int j = 0; j < gray.cols; j++) {
+			histogram[rptr[j]]++;
+		}
+	}
+}
+
+// Finds the otsu threshold from the histogram of numPixels pixels
+int otsuThreshold(const int histogram[256], int numPixels) {
+	double scale = 1.0 / numPixels;
+	double mu = 0;
+	for (int i = 0; i < 256; i++) {
+		mu += i * (double)histogram[i];
+	}
+	mu *= scale;
+
+	double mu1 = 0, q1 = 0, maxSigma = 0;
+	int maxVal = 0;
+	for (int i = 0; i < 256; i++) {
+		double p_i = histogram[i] * scale;
+		mu1 *= q1;
+		q1 += p_i;
+		double q2 = 1. - q1;
+		if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1. - FLT_EPSILON) {
+			continue;
+		}
+		mu1 = (mu1 + i * p_i) / q1;
+		double mu2 = (mu - q1 * mu1) / q2;
+		double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+		if (sigma > maxSigma) {
+			maxSigma = sigma;
+			maxVal = i;
+		}
+	}
+	return maxVal;
+}
+
+// Thresholds an 8 bit grayscale image straight into runs.
+// Pixels <= thresh are foreground.
+void thresholdToRLE(const cv::Mat& gray, int thresh, RLEMask& mask) {
+	resetMask(mask, gray.rows, gray.cols);
+	for (int i = 0; i < gray.rows; i++) {
+		const uchar* rptr = gray.ptr<uchar>(i);
+		int j = 0;
+		while (j < gray.cols) {
+			// skip background
+			while (j < gray.cols && rptr[j] > thresh) {
+				j++;
+			}
+			if (j == gray.cols) {
+				break;
+			}
+			int start = j;
+			while (j < gray.cols && rptr[j] <= thresh) {
+				j++;
+			}
+			mask.runs.push_back({ i, start, j, 0 });
+		}
+		endRow(mask);
+	}
+}
+
+// Encodes pixels equal to foregroundValue of an 8 bit image.
+void encodeRLE(const cv::Mat& src, int foregroundValue, RLEMask& mask) {
+	resetMask(mask, src.rows, src.cols);
+	for (int i = 0; i < src.rows; i++) {
+		const uchar* rptr = src.ptr<uchar>(i);
+		int j = 0;
+		while (j < src.cols) {
+			while (j < src.cols && rptr[j] != foregroundValue) {
+				j++;
+			}
+			if (j == src.cols) {
+				break;
+			}
+			int start = j;
+			while (j < src.cols && rptr[j] == foregroundValue) {
+				j++;
+			}
+			mask.runs.push_back({ i, start, j, 0 });
+		}
+		endRow(mask);
+	}
+}
+
+// Counts the zero bits below the lowest set bit, w must not be 0
+static inline int countTrailingZeros(uint64_t w) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, w);
+	return static_cast<int>(index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<unsigned long>(w))) {
+		return static_cast<int>(index);
+	}
+	_BitScanForward(&index, static_cast<unsigned long>(w >> 32));
+	return static_cast<int>(index) + 32;
+#else
+	return __builtin_ctzll(w);
+#endif
+}
+
+// ors count (<= 64) bits of value into bits, starting at bit pos
+static inline void orBits(std::vector<uint64_t>& bits, int pos, uint64_t value, int count) {
+	int word = pos >> 6;
+	int shift = pos & 63;
+	bits[word] |= value << shift;
+	if (shift + count > 64) {
+		bits[word + 1] |= value >> (64 - shift);
+	}
+}
+
+// first position >= pos (and < cols) whose bit is set (or clear),
+// cols if there is none
+static int findBit(const std::vector<uint64_t>& bits, int pos, bool set, int cols) {
+	if (pos >= cols) {
+		return cols;
+	}
+	int word = pos >> 6;
+	int numWords = static_cast<int>(bits.size());
+	uint64_t w = (set ? bits[word] : ~bits[word]) & (~0ULL << (pos & 63));
+	while (w == 0) {
+		if (++word == numWords) {
+			return cols;
+		}
+		w = set ? bits[word] : ~bits[word];
+	}
+	return std::min(cols, word * 64 + countTrailingZeros(w));
+}
+
+// adds addRow to and takes subtractRow from the column sums,
+// either row may be NULL
+static void updateColumnSums(std::vector<int>& columnSums, const uchar* addRow, const uchar* subtractRow) {
+	int cols = static_cast<int>(columnSums.size());
+	int* sums = columnSums.data();
+	int j = 0;
+#ifdef __AVX2__
+	for (; j + 8 <= cols; j += 8) {
+		__m256i colSum = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + j));
+		if (addRow != NULL) {
+			__m256i pixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(addRow + j)));
+			colSum = _mm256_add_epi32(colSum, pixels);
+		}
+		if (subtractRow != NULL) {
+			__m256i pixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(subtractRow + j)));
+			colSum = _mm256_sub_epi32(colSum, pixels);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + j), colSum);
+	}
+#endif
+	for (; j < cols; j++) {
+		if (addRow != NULL) {
+			sums[j] += addRow[j];
+		}
+		if (subtractRow != NULL) {
+			sums[j] -= subtractRow[j];
+		}
+	}
+}
+
+// Adaptive (mean) threshold straight into runs.
+// Column sums hold the rows of the window of the current row and are
+// updated by one row in and one row out, a prefix sum along the row
+// then gives every window sum with one subtraction. Foreground is found
+// as (pixel + offset) * count <= window sum, so no division is needed.
+void adaptiveThresholdToRLE(const cv::Mat& gray, int radius, int offset, RLEMask& mask) {
+	adaptiveThresholdToRLE(gray, radius, offset, 0, gray.rows, mask);
+}
+
+// Adaptive threshold of rows [rowBegin, rowEnd) only, windows still
+// reach into the rows around them
+void adaptiveThresholdToRLE(const cv::Mat& gray, int radius, int offset, int rowBegin, int rowEnd, RLEMask& mask) {
+	int rows = gray.rows;
+	int cols = gray.cols;
+	rowBegin = std::min(std::max(rowBegin, 0), rows);
+	rowEnd = std::min(std::max(rowEnd, rowBegin), rows);
+	resetMask(mask, rowEnd - rowBegin, cols);
+	if (rowEnd == rowBegin || cols == 0) {
+		return;
+	}
+	radius = std::max(radius, 0);
+
+	std::vector<int> columnSums(cols, 0);
+	std::vector<int> rowPrefix(cols + 1, 0);
+	std::vector<uint64_t> rowBits((cols + 63) / 64);
+
+	// the window of rowBegin is rows [rowBegin - radius, rowBegin + radius],
+	// the last of them is added below
+	for (int i = std::max(rowBegin - radius, 0); i < std::min(rowBegin + radius, rows); i++) {
+		updateColumnSums(columnSums, gray.ptr<uchar>(i), NULL);
+	}
+
+	// columns whose window is inside the image, so the count is the same
+	int interiorBegin = std::min(radius, cols);
+	int interiorEnd = std::max(cols - radius, interiorBegin);
+
+	for (int i = rowBegin; i < rowEnd; i++) {
+		// slide the window down to rows [i - radius, i + radius]
+		const uchar* addRow = i + radius < rows ? gray.ptr<uchar>(i + radius) : NULL;
+		const uchar* subtractRow = i - radius - 1 >= 0 && i > rowBegin ? gray.ptr<uchar>(i - radius - 1) : NULL;
+		updateColumnSums(columnSums, addRow, subtractRow);
+		int windowRows = std::min(i + radius, rows - 1) - std::max(i - radius, 0) + 1;
+
+		for (int j = 0; j < cols; j++) {
+			rowPrefix[j + 1] = rowPrefix[j] + columnSums[j];
+		}
+
+		const uchar* rptr = gray.ptr<uchar>(i);
+		std::fill(rowBits.begin(), rowBits.end(), 0);
+		auto thresholdPixel = [&](int j) {
+			int left = std::max(j - radius, 0);
+			int right = std::min(j + radius, cols - 1);
+			int windowSum = rowPrefix[right + 1] - rowPrefix[left];
+			int count = (right - left + 1) * windowRows;
+			if ((rptr[j] + offset) * count <= windowSum) {
+				rowBits[j >> 6] |= 1ULL << (j & 63);
+			}
+		};
+
+		int j = 0;
+		for (; j < interiorBegin; j++) {
+			thresholdPixel(j);
+		}
+#ifdef __AVX2__
+		// 8 pixels at a time, all with a full width window
+		const int* prefix = rowPrefix.data();
+		__m256i count = _mm256_set1_epi32((2 * radius + 1) * windowRows);
+		__m256i offsets = _mm256_set1_epi32(offset);
+		for (; j + 8 <= interiorEnd; j += 8) {
+			__m256i pixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rptr + j)));
+			__m256i scaled = _mm256_mullo_epi32(_mm256_add_epi32(pixels, offsets), count);
+			__m256i windowSums = _mm256_sub_epi32(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prefix + j + radius + 1)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prefix + j - radius)));
+			int background = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(scaled, windowSums)));
+			orBits(rowBits, j, static_cast<uint64_t>(~background & 0xFF), 8);
+		}
+#endif
+		// rest of the interior, same window count for every pixel
+		int interiorCount = (2 * radius + 1) * windowRows;
+		for (; j < interiorEnd; j++) {
+			int windowSum = rowPrefix[j + radius + 1] - rowPrefix[j - radius];
+			if ((rptr[j] + offset) * interiorCount <= windowSum) {
+				rowBits[j >> 6] |= 1ULL << (j & 63);
+			}
+		}
+		for (; j < cols; j++) {
+			thresholdPixel(j);
+		}
+
+		// runs are the stretches of set bits
+		j = 0;
+		while ((j = findBit(rowBits, j, true, cols)) < cols) {
+			int start = j;
+			j = findBit(rowBits, j, false, cols);
+			mask.runs.push_back({ i - rowBegin, start, j, 0 });
+		}
+		endRow(mask);
+	}
+}
+
+// interval [start, end)
+typedef std::pair<int, int> Interval;
+
+// merges sorted intervals that touch or overlap and appends them as
+// runs of row
+static void appendMerged(std::vector<Interval>& intervals, int row, RLEMask& dst) {
+	std::sort(intervals.begin(), intervals.end());
+	int i = 0;
+	while (i < intervals.size()) {
+		int start = intervals[i].first;
+		int end = intervals[i].second;
+		i++;
+		while (i < intervals.size() && intervals[i].first <= end) {
+			end = std::max(end, intervals[i].second);
+			i++;
+		}
+		dst.runs.push_back({ row, start, end, 0 });
+	}
+}
+
+// Dilates with a square (2 * radius + 1) kernel.
+// Output row r is the union of rows r - radius .. r + radius,
+// each run widened by radius.
+void dilateRLE(const RLEMask& src, RLEMask& dst, int radius) {
+	RLEMask result;
+	resetMask(result, src.rows, src.cols);
+	std::vector<Interval> intervals;
+	for (int r = 0; r < src.rows; r++) {
+		intervals.clear();
+		int firstRow = std::max(0, r - radius);
+		int lastRow = std::min(src.rows - 1, r + radius);
+		for (int idx = src.rowStart[firstRow]; idx < src.rowStart[lastRow + 1]; idx++) {
+			const Run& run = src.runs[idx];
+			intervals.push_back(Interval(std::max(0, run.start - radius), std::min(src.cols, run.end + radius)));
+		}
+		appendMerged(intervals, r, result);
+		endRow(result);
+	}
+	dst = std::move(result);
+}
+
+// runs of one source row shrunk by radius. Runs touching the image
+// edge do not shrink on that side, as pixels outside count as foreground.
+static void shrinkRow(const RLEMask& src, int row, int radius, std::vector<Interval>& shrunk) {
+	shrunk.clear();
+	for (int idx = src.rowStart[row]; idx < src.rowStart[row + 1]; idx++) {
+		const Run& run = src.runs[idx];
+		int start = run.start == 0 ? 0 : run.start + radius;
+		int end = run.end == src.cols ? src.cols : run.end - radius;
+		if (start < end) {
+			shrunk.push_back(Interval(start, end));
+		}
+	}
+}
+
+// intersects two sorted lists of intervals into out
+static void intersectIntervals(const std::vector<Interval>& a, const std::vector<Interval>& b, std::vector<Interval>& out) {
+	out.clear();
+	int i = 0, j = 0;
+	while (i < a.size() && j < b.size()) {
+		int start = std::max(a[i].first, b[j].first);
+		int end = std::min(a[i].second, b[j].second);
+		if (start < end) {
+			out.push_back(Interval(start, end));
+		}
+		// drop whichever ends first
+		if (a[i].second < b[j].second) {
+			i++;
+		}
+		else {
+			j++;
+		}
+	}
+}
+
+// Erodes with a square (2 * radius + 1) kernel.
+// Output row r is the intersection of rows r - radius .. r + radius
+// (rows outside the image count as full), each run shrunk by radius.
+void erodeRLE(const RLEMask& src, RLEMask& dst, int radius) {
+	RLEMask result;
+	resetMask(result, src.rows, src.cols);
+	std::vector<Interval> current, shrunk, intersected;
+	for (int r = 0; r < src.rows; r++) {
+		int firstRow = std::max(0, r - radius);
+		int lastRow = std::min(src.rows - 1, r + radius);
+		shrinkRow(src, firstRow, radius, current);
+		for (int row = firstRow + 1; row <= lastRow && !current.empty(); row++) {
+			shrinkRow(src, row, radius, shrunk);
+			intersectIntervals(current, shrunk, intersected);
+			current.swap(intersected);
+		}
+		for (const Interval& interval : current) {
+			result.runs.push_back({ r, interval.first, interval.second, 0 });
+		}
+		endRow(result);
+	}
+	dst = std::move(result);
+}
+
+// union find root with path halving
+static int findRoot(std::vector<int>& parent, int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+// joins two sets, the lower index stays root so the root of a
+// region is always its first run in raster order
+static void unionRuns(std::vector<int>& parent, int a, int b) {
+	a = findRoot(parent, a);
+	b = findRoot(parent, b);
+	if (a < b) {
+		parent[b] = a;
+	}
+	else if (b < a) {
+		parent[a] = b;
+	}
+}
+
+// joins runs of row r that touch a run in the row above,
+// diagonal neighbours included (8 connected)
+static void joinWithRowAbove(const RLEMask& mask, int r, std::vector<int>& parent) {
+	int above = mask.rowStart[r - 1];
+	int aboveEnd = mask.rowStart[r];
+	for (int idx = mask.rowStart[r]; idx < mask.rowStart[r + 1]; idx++) {
+		const Run& run = mask.runs[idx];
+		// skip runs above that end before this one can touch them
+		while (above < aboveEnd && mask.runs[above].end < run.start) {
+			above++;
+		}
+		for (int j = above; j < aboveEnd && mask.runs[j].start <= run.end; j++) {
+			unionRuns(parent, idx, j);
+		}
+	}
+}
+
+// numbers regions in order of their first run and sets every label.
+// Returns number of regions.
+static int numberRegions(RLEMask& mask, std::vector<int>& parent) {
+	int numOfRegions = 0;
+	for (int i = 0; i < static_cast<int>(mask.runs.size()); i++) {
+		int root = findRoot(parent, i);
+		if (root == i) {
+			mask.runs[i].label = ++numOfRegions;
+		}
+		else {
+			mask.runs[i].label = mask.runs[root].label;
+		}
+	}
+	return numOfRegions;
+}
+
+// Labels 8 connected regions by setting the label of every run.
+// Returns number of regions.
+int labelRuns(RLEMask& mask) {
+	int numRuns = static_cast<int>(mask.runs.size());
+	std::vector<int> parent(numRuns);
+	for (int i = 0; i < numRuns; i++) {
+		parent[i] = i;
+	}
+	for (int r = 1; r < mask.rows; r++) {
+		joinWithRowAbove(mask, r, parent);
+	}
+	return numberRegions(mask, parent);
+}
+
+// Labels a mask made of bands that were each labelled on their own.
+// Runs of a band start out joined to the first run of their band
+// label, so only the rows where bands meet are compared.
+int stitchBandLabels(RLEMask& mask, const std::vector<int>& bandStartRows) {
+	int numRuns = static_cast<int>(mask.runs.size());
+	std::vector<int> parent(numRuns);
+	// first run of each label of the current band
+	std::vector<int> firstRun;
+	for (int band = 0; band < bandStartRows.size(); band++) {
+		int bandEnd = band + 1 < bandStartRows.size() ? bandStartRows[band + 1] : mask.rows;
+		firstRun.clear();
+		for (int idx = mask.rowStart[bandStartRows[band]]; idx < mask.rowStart[bandEnd]; idx++) {
+			int label = mask.runs[idx].label;
+			if (label >= static_cast<int>(firstRun.size())) {
+				firstRun.resize(label + 1, -1);
+			}
+			if (firstRun[label] < 0) {
+				firstRun[label] = idx;
+			}
+			parent[idx] = firstRun[label];
+		}
+		if (bandStartRows[band] > 0) {
+			joinWithRowAbove(mask, bandStartRows[band], parent);
+		}
+	}
+	return numberRegions(mask, parent);
+}
+
+// Area (pixel count) of each region of a labelled mask
+void getRegionAreas(const RLEMask& mask, int numOfRegions, std::vector<int>& areas) {
+	areas.assign(numOfRegions + 1, 0);
+	for (const Run& run : mask.runs) {
+		areas[run.label] += run.end - run.start;
+	}
+}
+
+// Finds the largest region of a labelled mask
+int findLargestRegion(const RLEMask& mask, int numOfRegions) {
+	std::vector<int> areas;
+	getRegionAreas(mask, numOfRegions, areas);
+	int largestLabel = 0;
+	int largestArea = 0;
+	for (int i = 1; i <= numOfRegions; i++) {
+		if (areas[i] > largestArea) {
+			largestLabel = i;
+			largestArea = areas[i];
+		}
+	}
+	return largestLabel;
+}
+
+// Nearest neighbor resize, dst pixel x comes from src pixel
+// floor(x * src.cols / cols), so a run [start, end) covers the dst
+// pixels from ceil(start * cols / src.cols) to ceil(end * cols / src.cols)
+void resizeRLE(const RLEMask& src, int rows, int cols, RLEMask& dst) {
+	resetMask(dst, rows, cols);
+	if (src.rows == 0 || src.cols == 0) {
+		for (int i = 0; i < rows; i++) {
+			endRow(dst);
+		}
+		return;
+	}
+	auto scaleColumn = [&](int x) {
+		return static_cast<int>((static_cast<long long>(x) * cols + src.cols - 1) / src.cols);
+	};
+	for (int i = 0; i < rows; i++) {
+		int srcRow = static_cast<int>(static_cast<long long>(i) * src.rows / rows);
+		for (int r = src.rowStart[srcRow]; r < src.rowStart[srcRow + 1]; r++) {
+			const Run& run = src.runs[r];
+			int start = scaleColumn(run.start);
+			int end = scaleColumn(run.end);
+			if (start < end) {
+				// runs that shrink down to touch are merged
+				if (dst.rowStart.back() < static_cast<int>(dst.runs.size()) && dst.runs.back().end >= start
+					&& dst.runs.back().label == run.label) {
+					dst.runs.back().end = end;
+				}
+				else {
+					dst.runs.push_back({ i, start, end, run.label });
+				}
+			}
+		}
+		endRow(dst);
+	}
+}
+
+// Copies rows [rowBegin, rowEnd) of src to the bottom of dst
+void appendRowsRLE(const RLEMask& src, int rowBegin, int rowEnd, RLEMask& dst) {
+	if (dst.rowStart.empty()) {
+		resetMask(dst, 0, src.cols);
+	}
+	int rowOffset = dst.rows - rowBegin;
+	for (int r = rowBegin; r < rowEnd; r++) {
+		for (int idx = src.rowStart[r]; idx < src.rowStart[r + 1]; idx++) {
+			Run run = src.runs[idx];
+			run.row += rowOffset;
+			dst.runs.push_back(run);
+		}
+		endRow(dst);
+	}
+	dst.rows += rowEnd - rowBegin;
+}
+
+// Copies the runs of one region into region (label < 0 copies all).
+void extractRegion(const RLEMask& mask, int label, RLEMask& region) {
+	RLEMask result;
+	resetMask(result, mask.rows, mask.cols);
+	for (int r = 0; r < mask.rows; r++) {
+		for (int idx = mask.rowStart[r]; idx < mask.rowStart[r + 1]; idx++) {
+			if (label < 0 || mask.runs[idx].label == label) {
+				result.runs.push_back(mask.runs[idx]);
+			}
+		}
+		endRow(result);
+	}
+	region = std::move(result);
+}
+
+// sums of x^0..x^3 over the integers in [0, n]
+static double sum1(double n) { return n * (n + 1) / 2; }
+static double sum2(double n) { return n * (n + 1) * (2 * n + 1) / 6; }
+static double sum3(double n) { return sum1(n) * sum1(n); }
+
+// Raw, central and normalized moments of all runs of a mask,
+// in closed form per run.
+cv::Moments getMomentsRLE(const RLEMask& mask) {
+	double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0;
+	double m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+	for (const Run& run : mask.runs) {
+		// sums of x, x^2, x^3 for x in [start, end - 1]
+		double first = run.start - 1, last = run.end - 1;
+		double n = run.end - run.start;
+		double sx = sum1(last) - sum1(first);
+		double sx2 = sum2(last) - sum2(first);
+		double sx3 = sum3(last) - sum3(first);
+		double y = run.row;
+		m00 += n;
+		m10 += sx;
+		m01 += n * y;
+		m20 += sx2;
+		m11 += sx * y;
+		m02 += n * y * y;
+		m30 += sx3;
+		m21 += sx2 * y;
+		m12 += sx * y * y;
+		m03 += n * y * y * y;
+	}
+	// the constructor fills in the central and normalized moments
+	return cv::Moments(m00, m10, m01, m20, m11, m02, m30, m21, m12, m03);
+}
+
+// Pixel count of a mask.
+int getAreaRLE(const RLEMask& mask) {
+	int area = 0;
+	for (const Run& run : mask.runs) {
+		area += run.end - run.start;
+	}
+	return area;
+}
+
+// Expands a mask to an 8 bit image, 255 for foreground.
+void decodeRLE(const RLEMask& mask, cv::Mat& dst) {
+	dst = cv::Mat::zeros(mask.rows, mask.cols, CV_8UC1);
+	for (const Run& run : mask.runs) {
+		uchar* rptr = dst.ptr<uchar>(run.row);
+		std::fill(rptr + run.start, rptr + run.end, 255);
+	}
+}
+
+// Expands a labelled mask to a CV_32SC1 region id image.
+void decodeLabelMap(const RLEMask& mask, cv::Mat& labelMap) {
+	labelMap = cv::Mat::zeros(mask.rows, mask.cols, CV_32SC1);
+	for (const Run& run : mask.runs) {
+		int* rptr = labelMap.ptr<int>(run.row);
+		std::fill(rptr + run.start, rptr + run.end, run.label);
+	}
+}
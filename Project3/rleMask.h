@@ -0,0 +1,126 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    rleMask.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the run length encoded (RLE) binary
+			masks used by the segmentation. A mask is stored as
+			the horizontal runs of foreground pixels, so clean up,
+			region labelling, area and moments cost in proportion
+			to the number of runs (the object boundary) instead
+			of the number of pixels. Masks are only expanded back
+			to a cv::Mat for display.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// one run of foreground pixels in a row, columns [start, end)
+struct Run {
+	int row;
+	int start;
+	int end;
+	int label; // region id once labelled, 0 before
+};
+
+// Binary mask as runs in raster order (by row, then start).
+// Runs in a row never touch or overlap.
+struct RLEMask {
+	int rows = 0;
+	int cols = 0;
+	std::vector<Run> runs;
+	// runs of row r are runs[rowStart[r]] .. runs[rowStart[r + 1] - 1]
+	std::vector<int> rowStart;
+};
+
+// Finds the otsu threshold of an 8 bit grayscale image,
+// the same value cv::threshold with THRESH_OTSU picks.
+int otsuThreshold(const cv::Mat& gray);
+
+// Adds the pixels of an 8 bit grayscale image to a 256 bin histogram
+void addToHistogram(const cv::Mat& gray, int histogram[256]);
+
+// Otsu threshold from the 256 bin histogram of numPixels pixels,
+// e.g. summed over the strips of an image.
+int otsuThreshold(const int histogram[256], int numPixels);
+
+// Thresholds an 8 bit grayscale image straight into runs.
+// Pixels <= thresh are foreground (THRESH_BINARY_INV).
+void thresholdToRLE(const cv::Mat& gray, int thresh, RLEMask& mask);
+
+// Adaptive (mean) threshold of an 8 bit grayscale image straight into runs.
+// A pixel is foreground when it is <= the mean of the (2 * radius + 1)
+// square window around it minus offset, like cv::adaptiveThreshold with
+// ADAPTIVE_THRESH_MEAN_C and THRESH_BINARY_INV. Near the border the mean
+// is taken over the part of the window inside the image.
+// Window sums come from running column sums and a prefix sum along each
+// row, so the cost per pixel does not depend on radius. Sums are kept in
+// ints, which holds for any image with cols * (2 * radius + 1) < 8 million.
+void adaptiveThresholdToRLE(const cv::Mat& gray, int radius, int offset, RLEMask& mask);
+
+// Adaptive threshold of rows [rowBegin, rowEnd) of gray only, into a mask
+// of rowEnd - rowBegin rows. Windows reach into the rows around them, so
+// the runs are the same as those rows of the whole image's mask.
+void adaptiveThresholdToRLE(const cv::Mat& gray, int radius, int offset, int rowBegin, int rowEnd, RLEMask& mask);
+
+// Encodes pixels equal to foregroundValue of an 8 bit image.
+void encodeRLE(const cv::Mat& src, int foregroundValue, RLEMask& mask);
+
+// Dilates / erodes with a square (2 * radius + 1) kernel, the same as
+// cv::dilate / cv::erode with the default kernel and radius iterations.
+// Pixels outside the image do not grow (dilate) or shrink (erode) the mask.
+void dilateRLE(const RLEMask& src, RLEMask& dst, int radius);
+void erodeRLE(const RLEMask& src, RLEMask& dst, int radius);
+
+// Labels 8 connected regions by setting the label of every run.
+// Regions are numbered from 1 in raster order of their first pixel,
+// the same numbering as regionGrowing.
+// Returns number of regions.
+int labelRuns(RLEMask& mask);
+
+// Labels a mask made of horizontal bands that were each labelled with
+// labelRuns on their own (band b is rows bandStartRows[b] up to the next
+// band), joining regions that meet where the bands do.
+// Gives the same labels as labelRuns on the whole mask.
+// Returns number of regions.
+int stitchBandLabels(RLEMask& mask, const std::vector<int>& bandStartRows);
+
+// Area (pixel count) of each region of a labelled mask,
+// areas[label], areas[0] is unused.
+void getRegionAreas(const RLEMask& mask, int numOfRegions, std::vector<int>& areas);
+
+// Finds the largest region of a labelled mask, ties go to the
+// lower id like filterOnlylargestRegion.
+// Returns the ID of the region, 0 if there are no regions.
+int findLargestRegion(const RLEMask& mask, int numOfRegions);
+
+// Nearest neighbor resize of a (labelled) mask to rows x cols,
+// the same pixels cv::resize with INTER_NEAREST would give.
+// Labels are kept. Meant for growing a mask back to frame size, when
+// shrinking, runs of different regions may end up touching.
+void resizeRLE(const RLEMask& src, int rows, int cols, RLEMask& dst);
+
+// Copies rows [rowBegin, rowEnd) of src to the bottom of dst, labels
+// are kept. An empty dst (RLEMask()) takes the cols of src.
+void appendRowsRLE(const RLEMask& src, int rowBegin, int rowEnd, RLEMask& dst);
+
+// Copies the runs of one region into region (label < 0 copies all).
+void extractRegion(const RLEMask& mask, int label, RLEMask& region);
+
+// Raw, central and normalized moments of all runs of a mask
+// (as cv::moments(..., true) on the decoded mask), in closed form per run.
+cv::Moments getMomentsRLE(const RLEMask& mask);
+
+// Pixel count of a mask.
+int getAreaRLE(const RLEMask& mask);
+
+// Expands a mask to an 8 bit image, 255 for foreground.
+void decodeRLE(const RLEMask& mask, cv::Mat& dst);
+
+// Expands a labelled mask to a CV_32SC1 region id image.
+void decodeLabelMap(const RLEMask& mask, cv::Mat& labelMap);
@@ -0,0 +1,57 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    sharedFeatureDB.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the feature db shared by the
+			streams of a multi stream run. Streams classify
+			against read-only snapshots, and newly labelled
+			samples are published as a new snapshot, so the
+			streams never wait on each other or on training.
+ */
+
+#include "sharedFeatureDB.h"
+
+SharedFeatureDB::SharedFeatureDB(const FeatureDB& db)
+	: current(std::make_shared<const FeatureDB>(db)), publishedVersion(db.version)
+{
+}
+
+std::shared_ptr<const FeatureDB> SharedFeatureDB::snapshot() const {
+	return std::atomic_load(&current);
+}
+
+bool SharedFeatureDB::refresh(std::shared_ptr<const FeatureDB>& cached) const {
+	// the snapshot is stored before its version, so cached can be
+	// newer than the version read here but never missed
+	if (cached && cached->version >= publishedVersion.load(std::memory_order_acquire)) {
+		return false;
+	}
+	std::shared_ptr<const FeatureDB> newest = std::atomic_load(&current);
+	if (newest == cached) {
+		return false;
+	}
+	cached = std::move(newest);
+	return true;
+}
+
+void SharedFeatureDB::addSamples(const std::vector<TrainingSample>& samples) {
+	if (samples.empty()) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(writerMutex);
+	// no other writer can publish in between, so this is the newest
+	std::shared_ptr<FeatureDB> next = std::make_shared<FeatureDB>(*std::atomic_load(&current));
+	for (const TrainingSample& sample : samples) {
+		addFeatureRow(*next, sample.features, sample.label);
+	}
+	uint64_t nextVersion = next->version;
+	std::atomic_store(&current, std::shared_ptr<const FeatureDB>(std::move(next)));
+	publishedVersion.store(nextVersion, std::memory_order_release);
+}
+
+uint64_t SharedFeatureDB::version() const {
+	return publishedVersion.load(std::memory_order_acquire);
+}
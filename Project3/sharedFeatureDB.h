@@ -0,0 +1,61 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    sharedFeatureDB.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the feature db shared by the
+			streams of a multi stream run. Streams classify
+			against read-only snapshots, and newly labelled
+			samples are published as a new snapshot, so the
+			streams never wait on each other or on training.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "featureExtraction.h"
+#include "trainingCapture.h"
+
+// Versioned, read-only snapshots of a feature db.
+// A snapshot never changes once published: adding rows copies the
+// newest snapshot, appends to the copy and publishes it. Streams
+// holding an older snapshot keep using it until they refresh, and
+// it is freed when the last of them lets go.
+class SharedFeatureDB {
+public:
+	explicit SharedFeatureDB(const FeatureDB& db);
+
+	SharedFeatureDB(const SharedFeatureDB&) = delete;
+	SharedFeatureDB& operator=(const SharedFeatureDB&) = delete;
+
+	// Returns the newest snapshot
+	std::shared_ptr<const FeatureDB> snapshot() const;
+
+	// Makes cached the newest snapshot. While nothing new is published
+	// this only reads an atomic version, without any lock. (Loading a
+	// shared_ptr atomically may take a short internal lock, so it is
+	// only done when the version changed.)
+	// Returns true if cached was replaced.
+	bool refresh(std::shared_ptr<const FeatureDB>& cached) const;
+
+	// Adds the labelled samples as one new snapshot. Writers are
+	// serialized with each other, never with readers.
+	void addSamples(const std::vector<TrainingSample>& samples);
+
+	// version of the newest snapshot
+	uint64_t version() const;
+
+private:
+	// only accessed with std::atomic_load / std::atomic_store
+	std::shared_ptr<const FeatureDB> current;
+	// version of current, stored after current
+	std::atomic<uint64_t> publishedVersion;
+	std::mutex writerMutex;
+};
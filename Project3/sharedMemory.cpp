@@ -0,0 +1,339 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    sharedMemory.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the shared memory links to other
+			processes on the same machine. Frames can be taken
+			from a ring in shared memory written by another
+			process, and results are published as fixed size
+			binary records to a shared memory ring and/or a
+			UNIX datagram socket.
+ */
+
+#include <opencv2/core.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "sharedMemory.h"
+
+// size of the ring headers, so slots start cache line aligned
+static const uint64_t RING_HEADER_BYTES = 128;
+
+// how long the frame source sleeps while waiting for a frame
+static const int FRAME_POLL_MICROSECONDS = 100;
+// how long read waits between checks of readFor
+static const int FRAME_WAIT_MILLISECONDS = 100;
+
+// rounds n up to a multiple of 64
+static uint64_t alignTo64(uint64_t n) {
+	return (n + 63) & ~static_cast<uint64_t>(63);
+}
+
+// ns since the unix epoch, the clock used in ResultRecord
+long long wallClockNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Shared memory region
+ */
+SharedMemoryRegion::SharedMemoryRegion()
+	: address(NULL), mappedSize(0)
+{
+#ifdef _WIN32
+	mappingHandle = NULL;
+#endif
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+	release();
+}
+
+// creates and maps the region, never opens an existing one
+bool SharedMemoryRegion::create(const std::string& regionName, size_t size) {
+	release();
+#ifdef _WIN32
+	std::string objectName = "Local\\" + regionName;
+	HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32),
+		static_cast<DWORD>(size & 0xFFFFFFFF), objectName.c_str());
+	if (handle == NULL) {
+		printf("Unable to create shared memory %s\n", regionName.c_str());
+		return false;
+	}
+	if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		CloseHandle(handle);
+		printf("Shared memory %s is already in use\n", regionName.c_str());
+		return false;
+	}
+	address = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (address == NULL) {
+		CloseHandle(handle);
+		printf("Unable to map shared memory %s\n", regionName.c_str());
+		return false;
+	}
+	mappingHandle = handle;
+#else
+	// O_EXCL: another stream or process may be using a ring of this name
+	std::string objectName = "/" + regionName;
+	int fd = shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+	if (fd < 0) {
+		if (errno == EEXIST) {
+			printf("Shared memory %s is already in use (if no process is, remove /dev/shm/%s)\n",
+				regionName.c_str(), regionName.c_str());
+		}
+		else {
+			printf("Unable to create shared memory %s\n", regionName.c_str());
+		}
+		return false;
+	}
+	if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+		close(fd);
+		shm_unlink(objectName.c_str());
+		printf("Unable to size shared memory %s\n", regionName.c_str());
+		return false;
+	}
+	void* mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		shm_unlink(objectName.c_str());
+		printf("Unable to map shared memory %s\n", regionName.c_str());
+		return false;
+	}
+	address = mapped;
+#endif
+	name = regionName;
+	mappedSize = size;
+	return true;
+}
+
+// unmaps and removes the region. Processes that still have it
+// mapped keep their mapping, the name is free for a new ring.
+void SharedMemoryRegion::release() {
+	if (address == NULL) {
+		return;
+	}
+#ifdef _WIN32
+	// the mapping goes away with its last handle
+	UnmapViewOfFile(address);
+	CloseHandle(mappingHandle);
+	mappingHandle = NULL;
+#else
+	munmap(address, mappedSize);
+	shm_unlink(("/" + name).c_str());
+#endif
+	address = NULL;
+	mappedSize = 0;
+}
+
+/*
+ * Shared memory frame source
+ */
+SharedMemoryFrameSource::SharedMemoryFrameSource(const std::string& name, cv::Size size, int type, int numSlots, bool latestOnly)
+	: header(NULL), ringName(name), latestOnly(latestOnly),
+	holdingFrame(false), heldSequence(0), heldTimestampNs(0), heldFrameSequence(0)
+{
+	uint64_t step = static_cast<uint64_t>(size.width) * CV_ELEM_SIZE(type);
+	uint64_t slotBytes = alignTo64(SHARED_FRAME_SLOT_HEADER_BYTES + step * size.height);
+	if (numSlots <= 0 || size.width <= 0 || size.height <= 0
+		|| !region.create(name, RING_HEADER_BYTES + slotBytes * numSlots)) {
+		return;
+	}
+
+	// fresh ring, the producer waits for magic before writing
+	header = static_cast<SharedFrameRingHeader*>(region.data());
+	header->magic = 0;
+	header->version = SHARED_RING_VERSION;
+	header->width = size.width;
+	header->height = size.height;
+	header->type = type;
+	header->step = static_cast<uint32_t>(step);
+	header->numSlots = numSlots;
+	header->slotOffset = RING_HEADER_BYTES;
+	header->slotBytes = slotBytes;
+	new (&header->closed) std::atomic<uint32_t>(0);
+	new (&header->writeSequence) std::atomic<uint64_t>(0);
+	new (&header->readSequence) std::atomic<uint64_t>(0);
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = SHARED_FRAME_RING_MAGIC;
+}
+
+SharedMemoryFrameSource::~SharedMemoryFrameSource() {
+	if (header != NULL) {
+		releaseFrame();
+	}
+}
+
+// hands the slot of the last frame back to the producer
+void SharedMemoryFrameSource::releaseFrame() {
+	if (holdingFrame) {
+		header->readSequence.store(heldSequence + 1, std::memory_order_release);
+		holdingFrame = false;
+	}
+}
+
+// waits for the next frame and wraps it in place
+bool SharedMemoryFrameSource::read(cv::Mat& frame) {
+	FrameReadStatus status;
+	do {
+		status = readFor(frame, FRAME_WAIT_MILLISECONDS);
+	} while (status == FRAME_TIMEOUT);
+	return status == FRAME_READ;
+}
+
+// waits up to timeoutMs for the next frame and wraps it in place
+FrameReadStatus SharedMemoryFrameSource::readFor(cv::Mat& frame, int timeoutMs) {
+	if (header == NULL) {
+		return FRAME_END;
+	}
+	releaseFrame();
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+		+ std::chrono::milliseconds(timeoutMs);
+	for (;;) {
+		uint64_t writeSequence = header->writeSequence.load(std::memory_order_acquire);
+		uint64_t readSequence = header->readSequence.load(std::memory_order_relaxed);
+		if (writeSequence > readSequence) {
+			if (latestOnly && writeSequence - readSequence > 1) {
+				// drop the frames we are behind on
+				readSequence = writeSequence - 1;
+				header->readSequence.store(readSequence, std::memory_order_release);
+			}
+			uchar* slot = static_cast<uchar*>(region.data()) + header->slotOffset
+				+ (readSequence % header->numSlots) * header->slotBytes;
+			const SharedFrameSlotHeader* slotHeader = reinterpret_cast<const SharedFrameSlotHeader*>(slot);
+			frame = cv::Mat(header->height, header->width, header->type,
+				slot + SHARED_FRAME_SLOT_HEADER_BYTES, header->step);
+			holdingFrame = true;
+			heldSequence = readSequence;
+			heldTimestampNs = slotHeader->timestampNs;
+			heldFrameSequence = slotHeader->sequence;
+			return FRAME_READ;
+		}
+		if (header->closed.load(std::memory_order_acquire)) {
+			return FRAME_END;
+		}
+		if (std::chrono::steady_clock::now() >= deadline) {
+			return FRAME_TIMEOUT;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(FRAME_POLL_MICROSECONDS));
+	}
+}
+
+bool SharedMemoryFrameSource::isOpened() const {
+	return header != NULL;
+}
+
+std::string SharedMemoryFrameSource::name() const {
+	return "shared memory " + ringName;
+}
+
+bool SharedMemoryFrameSource::frameTimestamp(long long& timestampNs) const {
+	if (!holdingFrame) {
+		return false;
+	}
+	timestampNs = heldTimestampNs;
+	return true;
+}
+
+bool SharedMemoryFrameSource::frameSequence(unsigned long long& sequence) const {
+	if (!holdingFrame) {
+		return false;
+	}
+	sequence = heldFrameSequence;
+	return true;
+}
+
+/*
+ * Result publisher
+ */
+ResultPublisher::ResultPublisher(const std::string& sharedMemoryName, const std::string& socketPath, int numSlots)
+	: header(NULL), socketHandle(-1), socketPath(socketPath)
+{
+	if (!sharedMemoryName.empty() && numSlots > 0
+		&& region.create(sharedMemoryName, RING_HEADER_BYTES + sizeof(ResultRecord) * numSlots)) {
+		header = static_cast<SharedResultRingHeader*>(region.data());
+		header->magic = 0;
+		header->version = SHARED_RING_VERSION;
+		header->recordBytes = sizeof(ResultRecord);
+		header->numSlots = numSlots;
+		header->slotOffset = RING_HEADER_BYTES;
+		new (&header->writeSequence) std::atomic<uint64_t>(0);
+		std::atomic_thread_fence(std::memory_order_release);
+		header->magic = SHARED_RESULT_RING_MAGIC;
+	}
+	if (!socketPath.empty()) {
+#ifdef _WIN32
+		printf("Result socket is not supported on Windows, use shared memory\n");
+#else
+		socketHandle = socket(AF_UNIX, SOCK_DGRAM, 0);
+		if (socketHandle < 0) {
+			printf("Unable to create result socket\n");
+		}
+#endif
+	}
+}
+
+ResultPublisher::~ResultPublisher() {
+#ifndef _WIN32
+	if (socketHandle >= 0) {
+		close(socketHandle);
+	}
+#endif
+}
+
+// fills in labelId and label from the label string and publishes
+void ResultPublisher::publish(ResultRecord& record, const std::string& label, bool known) {
+	if (known) {
+		std::map<std::string, int>::iterator it = labelIds.find(label);
+		if (it == labelIds.end()) {
+			it = labelIds.insert(std::make_pair(label, static_cast<int>(labelIds.size()))).first;
+		}
+		record.labelId = it->second;
+	}
+	else {
+		record.labelId = -1;
+	}
+	memset(record.label, 0, sizeof(record.label));
+	strncpy(record.label, label.c_str(), sizeof(record.label) - 1);
+
+	if (header != NULL) {
+		uint64_t sequence = header->writeSequence.load(std::memory_order_relaxed);
+		uchar* slot = static_cast<uchar*>(region.data()) + header->slotOffset
+			+ (sequence % header->numSlots) * sizeof(ResultRecord);
+		memcpy(slot, &record, sizeof(ResultRecord));
+		header->writeSequence.store(sequence + 1, std::memory_order_release);
+	}
+#ifndef _WIN32
+	if (socketHandle >= 0) {
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+		// no reader or a full queue just drops the record
+		sendto(socketHandle, &record, sizeof(record), MSG_DONTWAIT,
+			reinterpret_cast<sockaddr*>(&address), sizeof(address));
+	}
+#endif
+}
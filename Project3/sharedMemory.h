@@ -0,0 +1,185 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    sharedMemory.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the shared memory links to other
+			processes on the same machine. Frames can be taken
+			from a ring in shared memory written by another
+			process, and results are published as fixed size
+			binary records to a shared memory ring and/or a
+			UNIX datagram socket.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <opencv2/core.hpp>
+
+#include "frameSource.h"
+
+/*
+ * Shared memory layouts. Both rings start with a header followed by
+ * the slots. All fields are little endian and naturally aligned, and
+ * the atomics are plain integers in memory.
+ */
+
+// "P3FR" / "P3RS"
+const uint32_t SHARED_FRAME_RING_MAGIC = 0x52463350;
+const uint32_t SHARED_RESULT_RING_MAGIC = 0x53523350;
+// 2 added ResultRecord::qualityLevel
+const uint32_t SHARED_RING_VERSION = 2;
+
+// Frame ring protocol:
+//	The pipeline creates the ring, and removes its name on exit. A
+//	name that is already in use is refused, never reset. The producer
+//	writes frame n into slot n % numSlots, fills in that slot's header
+//	(its sequence is reported back as frameSequence), then increments
+//	writeSequence. The slot belongs to the pipeline until readSequence
+//	passes n, so the producer must wait (or drop the frame) while
+//	writeSequence - readSequence == numSlots. Setting closed ends the
+//	stream once all written frames are read.
+struct SharedFrameRingHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t type; // OpenCV type, CV_8UC3 for BGR
+	uint32_t step; // bytes per row
+	uint32_t numSlots;
+	std::atomic<uint32_t> closed;
+	uint64_t slotOffset; // from start of the header to slot 0
+	uint64_t slotBytes;  // distance between slots, slot header included
+	std::atomic<uint64_t> writeSequence;
+	std::atomic<uint64_t> readSequence;
+};
+
+// header at the start of every frame slot, pixels follow at 64 bytes
+struct SharedFrameSlotHeader {
+	uint64_t sequence;
+	int64_t timestampNs; // producer clock, ns since the unix epoch
+};
+const uint64_t SHARED_FRAME_SLOT_HEADER_BYTES = 64;
+
+// One classification result, published once per frame.
+struct ResultRecord {
+	uint64_t frameSequence;    // from the producer if it gave one (slot sequence), else frame count
+	int64_t frameTimestampNs;  // ns since the unix epoch, from the producer if it gave one
+	int64_t resultTimestampNs; // ns since the unix epoch
+	int32_t labelId;           // -1 for unknown / no label, see ResultPublisher
+	float distance;            // distance to the label in std devs
+	float boxCenterX;          // rotated bounding box of the region, pixels
+	float boxCenterY;
+	float boxWidth;
+	float boxHeight;
+	float boxAngle;            // degrees, as cv::RotatedRect
+	float axisAngle;           // axis of least central moment, radians
+	int32_t qualityLevel;      // frame scheduler level the frame ran at, 0 is full quality
+	char label[32];            // null terminated, cut to fit
+};
+
+// Result ring protocol:
+//	Record n is written to slot n % numSlots, then writeSequence is
+//	set to n + 1. Readers copy slot (writeSequence - 1) % numSlots
+//	and may re-check writeSequence to detect an overrun.
+struct SharedResultRingHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t recordBytes;
+	uint32_t numSlots;
+	uint64_t slotOffset;
+	std::atomic<uint64_t> writeSequence;
+};
+
+// A named block of shared memory, created and mapped. The creator
+// owns it: the name is removed again when the region is destroyed.
+class SharedMemoryRegion {
+public:
+	SharedMemoryRegion();
+	~SharedMemoryRegion();
+
+	SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+	SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+	// creates and maps the region. Fails if a region with this name
+	// already exists, so a ring in use is never reset.
+	// Returns false on error.
+	bool create(const std::string& name, size_t size);
+
+	void* data() const { return address; }
+	size_t size() const { return mappedSize; }
+
+private:
+	// unmaps and removes the region
+	void release();
+
+	std::string name;
+	void* address;
+	size_t mappedSize;
+#ifdef _WIN32
+	void* mappingHandle;
+#endif
+};
+
+// Frames from a shared memory ring written by another process.
+// Frames are read in place from the ring, no copy is made.
+class SharedMemoryFrameSource : public FrameSource {
+public:
+	// Creates the ring with numSlots frames of size and type.
+	// latestOnly skips to the newest frame when behind.
+	SharedMemoryFrameSource(const std::string& name, cv::Size size, int type, int numSlots, bool latestOnly);
+	~SharedMemoryFrameSource();
+
+	bool read(cv::Mat& frame) override;
+	FrameReadStatus readFor(cv::Mat& frame, int timeoutMs) override;
+	bool isOpened() const override;
+	std::string name() const override;
+	bool frameTimestamp(long long& timestampNs) const override;
+	bool frameSequence(unsigned long long& sequence) const override;
+
+private:
+	// hands the slot of the last frame back to the producer
+	void releaseFrame();
+
+	SharedMemoryRegion region;
+	SharedFrameRingHeader* header;
+	std::string ringName;
+	bool latestOnly;
+	bool holdingFrame;
+	uint64_t heldSequence;
+	long long heldTimestampNs;
+	uint64_t heldFrameSequence;
+};
+
+// Publishes ResultRecords to a shared memory ring and/or a UNIX
+// datagram socket. Either name may be empty to leave it off.
+// Label ids are given in order of first appearance, and stay the
+// same for the life of the publisher.
+class ResultPublisher {
+public:
+	ResultPublisher(const std::string& sharedMemoryName, const std::string& socketPath, int numSlots = 256);
+	~ResultPublisher();
+
+	ResultPublisher(const ResultPublisher&) = delete;
+	ResultPublisher& operator=(const ResultPublisher&) = delete;
+
+	// fills in labelId and label from the label string and publishes.
+	// Never blocks, a socket with no reader drops the record.
+	void publish(ResultRecord& record, const std::string& label, bool known);
+
+private:
+	SharedMemoryRegion region;
+	SharedResultRingHeader* header;
+	std::map<std::string, int> labelIds;
+	int socketHandle;
+	std::string socketPath;
+};
+
+// ns since the unix epoch, the clock used in ResultRecord
+long long wallClockNs();
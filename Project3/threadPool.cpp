@@ -0,0 +1,136 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    threadPool.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains a small persistent thread pool
+			used to split data parallel work (such as the
+			DB scan of the classifiers) across all cores.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "threadPool.h"
+
+// Creates a pool with numThreads worker threads.
+ThreadPool::ThreadPool(int numThreads) : stopping(false) {
+	if (numThreads < 0) {
+		int cores = static_cast<int>(std::thread::hardware_concurrency());
+		numThreads = std::max(1, cores - 1);
+	}
+	for (int i = 0; i < numThreads; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+int ThreadPool::concurrency() const {
+	return static_cast<int>(workers.size()) + 1;
+}
+
+// worker threads sleep until a task is queued
+void ThreadPool::workerLoop() {
+	std::unique_lock<std::mutex> lock(queueMutex);
+	for (;;) {
+		taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+		if (stopping && tasks.empty()) {
+			return;
+		}
+		runPendingTask(lock);
+	}
+}
+
+// pops and runs one task with the lock released
+bool ThreadPool::runPendingTask(std::unique_lock<std::mutex>& lock) {
+	if (tasks.empty()) {
+		return false;
+	}
+	std::function<void()> task = std::move(tasks.front());
+	tasks.pop_front();
+	lock.unlock();
+	task();
+	lock.lock();
+	return true;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		tasks.push_back(std::move(task));
+	}
+	taskAvailable.notify_one();
+}
+
+// Splits [0, n) into contiguous chunks, one per thread.
+void ThreadPool::parallelFor(int n, const std::function<void(int, int, int)>& fn) {
+	if (n <= 0) {
+		return;
+	}
+	int numChunks = std::min(n, concurrency());
+	if (numChunks == 1) {
+		fn(0, n, 0);
+		return;
+	}
+
+	// chunk i covers [i*n/numChunks, (i+1)*n/numChunks)
+	std::shared_ptr<std::atomic<int>> remaining = std::make_shared<std::atomic<int>>(numChunks - 1);
+	for (int chunk = 1; chunk < numChunks; chunk++) {
+		int begin = static_cast<int>(static_cast<long long>(n) * chunk / numChunks);
+		int end = static_cast<int>(static_cast<long long>(n) * (chunk + 1) / numChunks);
+		submit([this, &fn, begin, end, chunk, remaining] {
+			fn(begin, end, chunk);
+			if (remaining->fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(queueMutex);
+				taskFinished.notify_all();
+			}
+		});
+	}
+
+	// calling thread takes the first chunk
+	fn(0, static_cast<int>(static_cast<long long>(n) / numChunks), 0);
+
+	// help with queued work while waiting, so nested calls
+	// from inside a worker can not deadlock the pool
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while (remaining->load() > 0) {
+		if (!runPendingTask(lock)) {
+			taskFinished.wait(lock, [this, &remaining] {
+				return remaining->load() == 0 || !tasks.empty();
+			});
+		}
+	}
+}
+
+// pool installed on this thread by a ScopedThreadPool, if any
+static thread_local ThreadPool* threadPoolOverride = nullptr;
+
+// Returns the pool of the calling thread, or the process wide pool
+ThreadPool& getSharedThreadPool() {
+	if (threadPoolOverride != nullptr) {
+		return *threadPoolOverride;
+	}
+	static ThreadPool pool;
+	return pool;
+}
+
+ScopedThreadPool::ScopedThreadPool(ThreadPool& pool) : previousPool(threadPoolOverride) {
+	threadPoolOverride = &pool;
+}
+
+ScopedThreadPool::~ScopedThreadPool() {
+	threadPoolOverride = previousPool;
+}
@@ -0,0 +1,80 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    threadPool.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains a small persistent thread pool
+			used to split data parallel work (such as the
+			DB scan of the classifiers) across all cores.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+	// Creates a pool with numThreads worker threads, with 0 all
+	// work runs on the calling thread. If numThreads < 0, one
+	// worker per hardware core (minus the calling thread) is created.
+	explicit ThreadPool(int numThreads = -1);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Number of chunks parallelFor splits work into
+	// (workers + the calling thread)
+	int concurrency() const;
+
+	// Splits [0, n) into contiguous chunks and runs
+	// fn(begin, end, chunkIdx) for each chunk. Chunk i always
+	// covers the i-th slice of the range, so callers can merge
+	// per chunk results in order for deterministic output.
+	// The calling thread works on chunks too, and blocks
+	// until every chunk is done.
+	void parallelFor(int n, const std::function<void(int, int, int)>& fn);
+
+	// Queues a single task to run on a worker.
+	void submit(std::function<void()> task);
+
+private:
+	void workerLoop();
+	// runs one queued task if any. Returns false if queue was empty.
+	bool runPendingTask(std::unique_lock<std::mutex>& lock);
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex queueMutex;
+	std::condition_variable taskAvailable;
+	std::condition_variable taskFinished;
+	bool stopping;
+};
+
+// Returns the pool installed on the calling thread by a
+// ScopedThreadPool, otherwise the process wide pool, created
+// on first use.
+ThreadPool& getSharedThreadPool();
+
+// Makes getSharedThreadPool() return pool on the calling thread
+// while this object lives, so the thread (e.g. one of several video
+// streams) splits its work over workers of its own instead of
+// queuing behind the work of other threads.
+class ScopedThreadPool {
+public:
+	explicit ScopedThreadPool(ThreadPool& pool);
+	~ScopedThreadPool();
+
+	ScopedThreadPool(const ScopedThreadPool&) = delete;
+	ScopedThreadPool& operator=(const ScopedThreadPool&) = delete;
+
+private:
+	ThreadPool* previousPool;
+};
@@ -0,0 +1,173 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    trainingCapture.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the training capture used by
+			the video loop. Samples are snapshotted when
+			spacebar is pressed, labelled on a console thread
+			and appended to the db file by a background writer,
+			so the live feed never waits on the operator or disk.
+ */
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+
+#include "featureExtraction.h"
+#include "trainingCapture.h"
+
+// width of the thumbnail kept with each sample
+static const int THUMBNAIL_WIDTH = 160;
+
+DBWriter::DBWriter(const std::string& filename)
+	: filename(filename), stopping(false)
+{
+	writerThread = std::thread(&DBWriter::writerLoop, this);
+}
+
+DBWriter::~DBWriter() {
+	{
+		std::lock_guard<std::mutex> lock(rowsMutex);
+		stopping = true;
+	}
+	rowsAvailable.notify_one();
+	writerThread.join();
+}
+
+// queues a row for writing. Does not block on disk.
+void DBWriter::enqueue(const FeatureVector& features, const std::string& label) {
+	std::string row = formatDBRow(features, label);
+	{
+		std::lock_guard<std::mutex> lock(rowsMutex);
+		rows.push_back(row);
+	}
+	rowsAvailable.notify_one();
+}
+
+// takes everything queued as one batch, appends and flushes it
+void DBWriter::writerLoop() {
+	std::unique_lock<std::mutex> lock(rowsMutex);
+	for (;;) {
+		rowsAvailable.wait(lock, [this] { return stopping || !rows.empty(); });
+		if (rows.empty()) {
+			return; // stopping and nothing left to write
+		}
+		std::deque<std::string> batch;
+		batch.swap(rows);
+		lock.unlock();
+
+		std::string batchRows;
+		for (const std::string& row : batch) {
+			batchRows += row;
+		}
+		if (appendDBRows(filename, batchRows, true)) {
+			printf("Saved %d sample(s) to %s.\n", static_cast<int>(batch.size()), filename.c_str());
+		}
+		lock.lock();
+	}
+}
+
+TrainingCapture::TrainingCapture()
+	: state(std::make_shared<State>()), nextId(1)
+{
+	labelThread = std::thread(&TrainingCapture::labelLoop, state);
+}
+
+// If the console thread is still blocked reading a label it can not
+// be woken, so it is detached instead of joined. It owns its own
+// reference to the shared state, and exits with the process.
+TrainingCapture::~TrainingCapture() {
+	bool blockedOnInput;
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->stopping = true;
+		blockedOnInput = state->waitingForInput;
+	}
+	state->samplesAvailable.notify_one();
+	if (blockedOnInput) {
+		labelThread.detach();
+	}
+	else {
+		labelThread.join();
+	}
+}
+
+// snapshots features and a thumbnail of frame
+int TrainingCapture::submit(const FeatureVector& features, const cv::Mat& frame) {
+	TrainingSample sample;
+	sample.id = nextId++;
+	sample.features = features;
+	if (!frame.empty()) {
+		int height = std::max(1, frame.rows * THUMBNAIL_WIDTH / frame.cols);
+		cv::resize(frame, sample.thumbnail, cv::Size(THUMBNAIL_WIDTH, height), 0, 0, cv::INTER_AREA);
+	}
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->pending.push_back(sample);
+	}
+	state->samplesAvailable.notify_one();
+	return sample.id;
+}
+
+// moves every sample labelled since the last call into labelled
+int TrainingCapture::collectLabelled(std::vector<TrainingSample>& labelled) {
+	std::lock_guard<std::mutex> lock(state->mutex);
+	int count = static_cast<int>(state->labelled.size());
+	for (TrainingSample& sample : state->labelled) {
+		labelled.push_back(std::move(sample));
+	}
+	state->labelled.clear();
+	return count;
+}
+
+// thumbnail of the sample currently waiting for a label
+bool TrainingCapture::pendingThumbnail(cv::Mat& thumbnail) {
+	std::lock_guard<std::mutex> lock(state->mutex);
+	if (state->pending.empty()) {
+		return false;
+	}
+	thumbnail = state->pending.front().thumbnail;
+	return true;
+}
+
+// console thread, asks for the label of the oldest pending sample
+void TrainingCapture::labelLoop(std::shared_ptr<State> state) {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	for (;;) {
+		state->samplesAvailable.wait(lock, [&state] {
+			return state->stopping || !state->pending.empty();
+		});
+		if (state->stopping) {
+			return;
+		}
+		int id = state->pending.front().id;
+		state->waitingForInput = true;
+		lock.unlock();
+
+		std::string label;
+		std::cout << "Enter label for sample " << id << " (empty to discard): " << std::flush;
+		bool gotLine = static_cast<bool>(std::getline(std::cin, label));
+
+		lock.lock();
+		state->waitingForInput = false;
+		TrainingSample sample = std::move(state->pending.front());
+		state->pending.pop_front();
+		if (!gotLine) {
+			// console closed, no more labels can be read
+			state->pending.clear();
+			return;
+		}
+		if (!label.empty()) {
+			std::cout << "Label: " << label << std::endl;
+			sample.label = label;
+			state->labelled.push_back(std::move(sample));
+		}
+	}
+}
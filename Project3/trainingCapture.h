@@ -0,0 +1,102 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    trainingCapture.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the training capture used by
+			the video loop. Samples are snapshotted when
+			spacebar is pressed, labelled on a console thread
+			and appended to the db file by a background writer,
+			so the live feed never waits on the operator or disk.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "featureRecord.h"
+
+// a sample snapshotted from the live feed
+struct TrainingSample {
+	int id;
+	FeatureVector features;
+	cv::Mat thumbnail;
+	std::string label; // empty until labelled
+};
+
+// Appends labelled samples to the db file on a background thread.
+// Everything queued since the last write is appended as one batch
+// and flushed to disk before the next batch is taken.
+class DBWriter {
+public:
+	explicit DBWriter(const std::string& filename);
+	// writes anything still queued before returning
+	~DBWriter();
+
+	DBWriter(const DBWriter&) = delete;
+	DBWriter& operator=(const DBWriter&) = delete;
+
+	// queues a row for writing. Does not block on disk.
+	void enqueue(const FeatureVector& features, const std::string& label);
+
+private:
+	void writerLoop();
+
+	std::string filename;
+	std::deque<std::string> rows;
+	std::mutex rowsMutex;
+	std::condition_variable rowsAvailable;
+	bool stopping;
+	std::thread writerThread;
+};
+
+// Holds snapshotted samples and asks for their labels on a
+// console thread, one at a time in capture order.
+class TrainingCapture {
+public:
+	TrainingCapture();
+	// stops the console thread (see .cpp for the pending input case)
+	~TrainingCapture();
+
+	TrainingCapture(const TrainingCapture&) = delete;
+	TrainingCapture& operator=(const TrainingCapture&) = delete;
+
+	// snapshots features and a thumbnail of frame.
+	// Returns the id of the sample.
+	int submit(const FeatureVector& features, const cv::Mat& frame);
+
+	// moves every sample labelled since the last call into labelled.
+	// Samples given an empty label are dropped.
+	// Returns number of samples moved.
+	int collectLabelled(std::vector<TrainingSample>& labelled);
+
+	// thumbnail of the sample currently waiting for a label.
+	// Returns false if no sample is waiting.
+	bool pendingThumbnail(cv::Mat& thumbnail);
+
+private:
+	// state shared with the console thread
+	struct State {
+		std::deque<TrainingSample> pending;
+		std::vector<TrainingSample> labelled;
+		std::mutex mutex;
+		std::condition_variable samplesAvailable;
+		bool stopping = false;
+		bool waitingForInput = false;
+	};
+	static void labelLoop(std::shared_ptr<State> state);
+
+	std::shared_ptr<State> state;
+	std::thread labelThread;
+	int nextId;
+};
@@ -0,0 +1,481 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    verification.cpp
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the verification run. The optimized
+			segmentation, features and classifiers are run next to
+			the frozen reference copies (referenceImplementations.h)
+			on random images and dbs, their results compared, and
+			both timed for growing image and db sizes.
+ */
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "verification.h"
+#include "referenceImplementations.h"
+#include "imageProcessing.h"
+#include "featureExtraction.h"
+#include "frameSource.h"
+#include "rleMask.h"
+#include "sharedMemory.h"
+
+// fixed so a failure can be reproduced
+static const unsigned int VERIFICATION_SEED = 20261019;
+// only the first failures are printed in full
+static const int MAX_PRINTED_FAILURES = 20;
+// features and distances may differ by this much (relative), they are
+// computed from the same moments in a different order
+static const double RELATIVE_TOLERANCE = 1e-6;
+// degree of each hu moment in the normalized central moments, used to
+// scale the absolute tolerance of the small ones
+static const int HU_DEGREE[7] = { 1, 2, 3, 3, 6, 4, 6 };
+// filterOnlylargestRegion costs regions * pixels, above this the
+// largest region of the reference label map is found by counting
+static const double MAX_REFERENCE_FILTER_WORK = 2e9;
+// rough size of each feature in a real db, the synthetic
+// dbs spread their clusters over the same scales
+static const double FEATURE_SCALES[NUM_SHAPE_FEATURES] = { 50, 3, 0.3, 0.05, 0.01, 1e-3, 1e-4, 1e-5, 1e-6 };
+
+// results of all checks so far
+struct VerificationStats {
+	int checks = 0;
+	int failures = 0;
+};
+
+// one point of a scaling curve
+struct ScalingRow {
+	std::string stage;
+	std::string size;
+	int numLabels;
+	double newMs;
+	double referenceMs;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// counts a check, and prints it if it failed
+static bool check(VerificationStats& stats, bool passed, const char* format, ...) {
+	stats.checks++;
+	if (passed) {
+		return true;
+	}
+	stats.failures++;
+	if (stats.failures <= MAX_PRINTED_FAILURES) {
+		va_list args;
+		va_start(args, format);
+		printf("  FAIL ");
+		vprintf(format, args);
+		printf("\n");
+		va_end(args);
+	}
+	return false;
+}
+
+// true if both images have the same size, type and pixels
+static bool sameImage(const cv::Mat& a, const cv::Mat& b) {
+	if (a.size() != b.size() || a.type() != b.type()) {
+		return false;
+	}
+	cv::Mat differ = a != b;
+	return cv::countNonZero(differ) == 0;
+}
+
+// a == b within tol, also true when both are the same inf or both nan
+static bool closeEnough(double a, double b, double tol) {
+	if (a == b || (std::isnan(a) && std::isnan(b))) {
+		return true;
+	}
+	return fabs(a - b) <= tol;
+}
+
+// Returns the first feature that is out of tolerance, -1 if none
+static int firstFeatureMismatch(const FeatureVector& features, const std::vector<double>& reference) {
+	for (int i = 0; i < NUM_SHAPE_FEATURES; i++) {
+		double tol = RELATIVE_TOLERANCE * fabs(reference[i]);
+		if (i >= 2) {
+			tol += 1e-12 * pow(fabs(reference[2]), HU_DEGREE[i - 2]);
+		}
+		if (!closeEnough(features[i], reference[i], tol)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// compares both getFeatures with the reference on the same region
+static void compareFeatures(VerificationStats& stats, const RLEMask& region, const cv::Mat& referenceRegion, const std::string& name) {
+	std::vector<double> referenceFeatures;
+	referenceGetFeatures(referenceRegion, referenceFeatures);
+
+	FeatureVector features;
+	getFeatures(region, features);
+	int mismatch = firstFeatureMismatch(features, referenceFeatures);
+	check(stats, mismatch < 0, "%s: getFeatures (runs) feature %d is %.10g, reference %.10g", name.c_str(),
+		mismatch, mismatch < 0 ? 0.0 : features[mismatch], mismatch < 0 ? 0.0 : referenceFeatures[mismatch]);
+
+	getFeatures(referenceRegion, features);
+	mismatch = firstFeatureMismatch(features, referenceFeatures);
+	check(stats, mismatch < 0, "%s: getFeatures (image) feature %d is %.10g, reference %.10g", name.c_str(),
+		mismatch, mismatch < 0 ? 0.0 : features[mismatch], mismatch < 0 ? 0.0 : referenceFeatures[mismatch]);
+}
+
+static std::string sizeName(cv::Size size) {
+	return std::to_string(size.width) + "x" + std::to_string(size.height);
+}
+
+// segmentFrame against the original pipeline on synthetic frames
+static void verifySegmentation(VerificationStats& stats, cv::RNG& rng, cv::Size size, int numCases, std::vector<ScalingRow>& scaling) {
+	double newMs = 0, referenceMs = 0;
+	for (int c = 0; c < numCases; c++) {
+		std::string name = "segmentFrame " + sizeName(size) + " case " + std::to_string(c);
+		int numBlobs = rng.uniform(1, 9);
+		double noise = rng.uniform(0.0, 20.0);
+		SyntheticFrameSource source(size, numBlobs, noise, static_cast<unsigned int>(rng.uniform(0, 1 << 30)));
+		// let the blobs drift to a random place
+		cv::Mat frame;
+		for (int skip = rng.uniform(1, 30); skip > 0; skip--) {
+			source.read(frame);
+		}
+
+		Clock::time_point start = Clock::now();
+		SegmentationResult segmentation;
+		segmentFrame(frame, segmentation);
+		newMs += elapsedMs(start);
+
+		start = Clock::now();
+		cv::Mat thresholdImage, cleanedImage, labelMap, largestRegionImage;
+		int referenceRegions;
+		int referenceLargest = referenceSegmentFrame(frame, thresholdImage, cleanedImage, labelMap, referenceRegions, largestRegionImage);
+		referenceMs += elapsedMs(start);
+
+		cv::Mat decoded;
+		decodeRLE(segmentation.thresholdMask, decoded);
+		check(stats, sameImage(decoded, thresholdImage), "%s: threshold mask differs", name.c_str());
+		decodeRLE(segmentation.cleanedMask, decoded);
+		check(stats, sameImage(decoded, cleanedImage), "%s: cleaned mask differs", name.c_str());
+		check(stats, segmentation.numOfRegions == referenceRegions, "%s: %d regions, reference %d", name.c_str(),
+			segmentation.numOfRegions, referenceRegions);
+		decodeLabelMap(segmentation.cleanedMask, decoded);
+		check(stats, sameImage(decoded, labelMap), "%s: region ids differ", name.c_str());
+		check(stats, segmentation.largestRegionId == referenceLargest, "%s: largest region %d, reference %d", name.c_str(),
+			segmentation.largestRegionId, referenceLargest);
+		// with no region the reference "largest region" is the background
+		if (referenceLargest > 0) {
+			decodeRLE(segmentation.largestRegion, decoded);
+			check(stats, sameImage(decoded, largestRegionImage), "%s: largest region mask differs", name.c_str());
+			compareFeatures(stats, segmentation.largestRegion, largestRegionImage, name);
+		}
+	}
+	scaling.push_back({ "segmentFrame", sizeName(size), 0, newMs / numCases, referenceMs / numCases });
+}
+
+// binary image of random filled ellipses and rotated rectangles,
+// with a fraction noise of the pixels flipped
+static void randomBinaryImage(cv::RNG& rng, cv::Size size, int numBlobs, double noise, cv::Mat& image) {
+	image = cv::Mat::zeros(size, CV_8UC1);
+	int minSide = std::min(size.width, size.height);
+	for (int i = 0; i < numBlobs; i++) {
+		cv::Point2f center((float)rng.uniform(0.0, (double)size.width), (float)rng.uniform(0.0, (double)size.height));
+		cv::Size axes(rng.uniform(1, minSide / 6 + 2), rng.uniform(1, minSide / 6 + 2));
+		double angle = rng.uniform(0.0, 180.0);
+		if (rng.uniform(0, 2) == 0) {
+			cv::ellipse(image, center, axes, angle, 0, 360, cv::Scalar(255), cv::FILLED);
+		}
+		else {
+			cv::RotatedRect rect(center, cv::Size2f((float)axes.width * 2, (float)axes.height * 2), (float)angle);
+			cv::Point2f corners[4];
+			rect.points(corners);
+			std::vector<cv::Point> polygon(corners, corners + 4);
+			cv::fillConvexPoly(image, polygon, cv::Scalar(255));
+		}
+	}
+	if (noise > 0) {
+		for (int i = 0; i < image.rows; i++) {
+			uchar* rptr = image.ptr<uchar>(i);
+			for (int j = 0; j < image.cols; j++) {
+				if (rng.uniform(0.0, 1.0) < noise) {
+					rptr[j] = 255 - rptr[j];
+				}
+			}
+		}
+	}
+}
+
+// run labelling against regionGrowing / filterOnlylargestRegion on binary images
+static void verifyLabelling(VerificationStats& stats, cv::RNG& rng, cv::Size size, int numCases, std::vector<ScalingRow>& scaling) {
+	double newMs = 0, referenceMs = 0;
+	int numTimed = 0;
+	for (int c = 0; c < numCases; c++) {
+		std::string name = "labelling " + sizeName(size) + " case " + std::to_string(c);
+		// clean blobs, blobs with specks, many blobs
+		int numBlobs = c % 3 == 2 ? rng.uniform(10, 40) : rng.uniform(1, 12);
+		double noise = c % 3 == 1 ? rng.uniform(1e-5, 5e-4) : 0.0;
+		cv::Mat image;
+		randomBinaryImage(rng, size, numBlobs, noise, image);
+
+		Clock::time_point start = Clock::now();
+		RLEMask mask, largestRegion;
+		encodeRLE(image, 255, mask);
+		int numOfRegions = labelRuns(mask);
+		int largestRegionId = findLargestRegion(mask, numOfRegions);
+		extractRegion(mask, largestRegionId, largestRegion);
+		double caseNewMs = elapsedMs(start);
+
+		start = Clock::now();
+		cv::Mat labelMap, largestRegionImage;
+		int referenceRegions = referenceRegionGrowing(image, labelMap, 255);
+		int referenceLargest;
+		bool filterRun = (double)referenceRegions * image.total() <= MAX_REFERENCE_FILTER_WORK;
+		if (filterRun) {
+			referenceLargest = referenceFilterOnlylargestRegion(image, labelMap, largestRegionImage, referenceRegions);
+			newMs += caseNewMs;
+			referenceMs += elapsedMs(start);
+			numTimed++;
+		}
+		else {
+			// too many regions for the reference, count areas instead
+			std::vector<int> areas(referenceRegions + 1, 0);
+			for (int i = 0; i < labelMap.rows; i++) {
+				const int* rptr = labelMap.ptr<int>(i);
+				for (int j = 0; j < labelMap.cols; j++) {
+					areas[rptr[j]]++;
+				}
+			}
+			referenceLargest = 0;
+			for (int id = 1; id <= referenceRegions; id++) {
+				if (areas[id] > areas[referenceLargest] || referenceLargest == 0) {
+					referenceLargest = id;
+				}
+			}
+			largestRegionImage = labelMap == referenceLargest;
+		}
+
+		cv::Mat decoded;
+		check(stats, numOfRegions == referenceRegions, "%s: %d regions, reference %d", name.c_str(), numOfRegions, referenceRegions);
+		decodeLabelMap(mask, decoded);
+		check(stats, sameImage(decoded, labelMap), "%s: region ids differ", name.c_str());
+		check(stats, largestRegionId == referenceLargest, "%s: largest region %d, reference %d", name.c_str(),
+			largestRegionId, referenceLargest);
+		if (referenceLargest > 0) {
+			decodeRLE(largestRegion, decoded);
+			check(stats, sameImage(decoded, largestRegionImage), "%s: largest region mask differs", name.c_str());
+			compareFeatures(stats, largestRegion, largestRegionImage, name);
+		}
+	}
+	if (numTimed > 0) {
+		scaling.push_back({ "labelling", sizeName(size), 0, newMs / numTimed, referenceMs / numTimed });
+	}
+}
+
+// Synthetic db in both layouts. Each label is a cluster around its
+// own center, every label has at least one row.
+static void randomDB(cv::RNG& rng, int numRows, int numLabels, FeatureDB& db,
+	std::vector<std::vector<double>>& referenceFeatures, std::vector<std::string>& referenceLabels)
+{
+	std::vector<FeatureVector> centers(numLabels);
+	std::vector<std::string> names(numLabels);
+	for (int label = 0; label < numLabels; label++) {
+		for (int i = 0; i < NUM_SHAPE_FEATURES; i++) {
+			centers[label][i] = FEATURE_SCALES[i] * rng.uniform(0.2, 2.0);
+		}
+		char name[16];
+		snprintf(name, sizeof(name), "part%03d", label);
+		names[label] = name;
+	}
+
+	db = FeatureDB();
+	db.allFeatures.reserve(numRows);
+	db.labels.reserve(numRows);
+	referenceFeatures.assign(numRows, std::vector<double>(NUM_SHAPE_FEATURES));
+	referenceLabels.resize(numRows);
+	FeatureVector row;
+	row.schemaId = FEATURE_SCHEMA_SHAPE_V1;
+	for (int r = 0; r < numRows; r++) {
+		int label = r < numLabels ? r : rng.uniform(0, numLabels);
+		for (int i = 0; i < NUM_SHAPE_FEATURES; i++) {
+			row[i] = centers[label][i] + 0.05 * FEATURE_SCALES[i] * rng.gaussian(1.0);
+			referenceFeatures[r][i] = row[i];
+		}
+		addFeatureRow(db, row, names[label]);
+		referenceLabels[r] = names[label];
+	}
+}
+
+// query of one of three kinds: a copy of a row, near a row, far from everything
+static void randomQuery(cv::RNG& rng, const FeatureDB& db, int kind, FeatureVector& query) {
+	const FeatureVector& row = db.allFeatures[rng.uniform(0, static_cast<int>(db.allFeatures.size()))];
+	query.schemaId = FEATURE_SCHEMA_SHAPE_V1;
+	for (int i = 0; i < NUM_SHAPE_FEATURES; i++) {
+		if (kind == 0) {
+			query[i] = row[i];
+		}
+		else if (kind == 1) {
+			query[i] = row[i] + 0.02 * FEATURE_SCALES[i] * rng.gaussian(1.0);
+		}
+		else {
+			query[i] = FEATURE_SCALES[i] * rng.uniform(-10.0, 10.0);
+		}
+	}
+}
+
+// both classifiers against the reference copies on one synthetic db
+static void verifyClassifiers(VerificationStats& stats, cv::RNG& rng, int numRows, int numLabels, int numQueries, std::vector<ScalingRow>& scaling) {
+	FeatureDB db;
+	std::vector<std::vector<double>> referenceFeatures;
+	std::vector<std::string> referenceLabels;
+	randomDB(rng, numRows, numLabels, db, referenceFeatures, referenceLabels);
+	std::string dbName = std::to_string(numRows) + " rows " + std::to_string(numLabels) + " labels";
+
+	// every k on small dbs, the reference is too slow for more on large ones
+	std::vector<int> ks;
+	if (numRows <= 100000) {
+		ks = { 1, 2, 3 };
+	}
+	else {
+		ks = { 2 };
+	}
+
+	double nearestMs = 0, referenceNearestMs = 0, knnMs = 0, referenceKnnMs = 0;
+	for (int q = 0; q < numQueries; q++) {
+		std::string name = dbName + " query " + std::to_string(q);
+		FeatureVector query;
+		randomQuery(rng, db, q % 3, query);
+		std::vector<double> referenceQuery(query.begin(), query.end());
+
+		std::string label, referenceLabel;
+		Clock::time_point start = Clock::now();
+		int nearestIndex = nearestNeigborDistance(query, db, label);
+		nearestMs += elapsedMs(start);
+		start = Clock::now();
+		int referenceIndex = referenceNearestNeigborDistance(referenceQuery, referenceFeatures, referenceLabels, referenceLabel);
+		referenceNearestMs += elapsedMs(start);
+		check(stats, nearestIndex == referenceIndex && label == referenceLabel,
+			"%s: nearest row %d (%s), reference %d (%s)", name.c_str(),
+			nearestIndex, label.c_str(), referenceIndex, referenceLabel.c_str());
+
+		for (int k : ks) {
+			double distance, referenceDistance;
+			start = Clock::now();
+			int result = kNearestNeigborDistance(query, db, k, 1, label, distance);
+			double ms = elapsedMs(start);
+			start = Clock::now();
+			int referenceResult = referenceKNearestNeigborDistance(referenceQuery, referenceFeatures, referenceLabels,
+				k, 1, referenceLabel, referenceDistance);
+			double referenceMs = elapsedMs(start);
+			if (k == 2) {
+				knnMs += ms;
+				referenceKnnMs += referenceMs;
+			}
+			check(stats, label == referenceLabel && (result < 0) == (referenceResult < 0)
+				&& closeEnough(distance, referenceDistance, RELATIVE_TOLERANCE * fabs(referenceDistance)),
+				"%s k=%d: %s at %.8g, reference %s at %.8g", name.c_str(), k,
+				label.c_str(), distance, referenceLabel.c_str(), referenceDistance);
+		}
+	}
+	std::string size = std::to_string(numRows);
+	scaling.push_back({ "nearestNeigbor", size, numLabels, nearestMs / numQueries, referenceNearestMs / numQueries });
+	scaling.push_back({ "kNearestNeigbor k=2", size, numLabels, knnMs / numQueries, referenceKnnMs / numQueries });
+}
+
+// Compares the optimized paths with the reference copies
+// Two regions of different names must be two objects, a name in use
+// must be refused, and a destroyed region must free its name
+static void verifySharedMemory(VerificationStats& stats) {
+	// unique per run, so a left over region can not make it pass
+	std::string prefix = "p3verify" + std::to_string(wallClockNs() % 1000000000LL);
+	const size_t size = 4096;
+	{
+		SharedMemoryRegion first, second, duplicate;
+		bool firstCreated = first.create(prefix + "a", size);
+		bool secondCreated = second.create(prefix + "b", size);
+		check(stats, firstCreated && secondCreated, "shared memory: two named regions, created %d %d",
+			firstCreated, secondCreated);
+		if (firstCreated && secondCreated) {
+			memset(first.data(), 1, size);
+			memset(second.data(), 2, size);
+			const uchar* firstBytes = static_cast<const uchar*>(first.data());
+			check(stats, firstBytes[0] == 1 && firstBytes[size - 1] == 1,
+				"shared memory: writing one region changed the other");
+		}
+		printf("  (a refused region is expected next)\n");
+		check(stats, !duplicate.create(prefix + "a", size), "shared memory: region in use was created again");
+	}
+	SharedMemoryRegion reused;
+	check(stats, reused.create(prefix + "a", size), "shared memory: name not freed when the region was destroyed");
+}
+
+int executeVerification(bool full, const std::string& scalingFile) {
+	cv::RNG rng(VERIFICATION_SEED);
+	VerificationStats stats;
+	std::vector<ScalingRow> scaling;
+	printf("Verifying against the reference implementations (%s run, seed %u)\n", full ? "full" : "quick", VERIFICATION_SEED);
+
+	printf("shared memory\n");
+	verifySharedMemory(stats);
+
+	std::vector<cv::Size> imageSizes = { cv::Size(320, 240), cv::Size(640, 480), cv::Size(1280, 720), cv::Size(1920, 1080) };
+	if (full) {
+		imageSizes.push_back(cv::Size(2560, 1440));
+		imageSizes.push_back(cv::Size(3840, 2160));
+	}
+	for (const cv::Size& size : imageSizes) {
+		printf("images %s\n", sizeName(size).c_str());
+		int numCases = size.area() > 1920 * 1080 ? 3 : 6;
+		verifySegmentation(stats, rng, size, numCases, scaling);
+		verifyLabelling(stats, rng, size, numCases, scaling);
+	}
+
+	std::vector<int> dbSizes = { 1000, 10000, 100000, 1000000 };
+	if (full) {
+		dbSizes.push_back(10000000);
+	}
+	const int labelCounts[2] = { 5, 500 };
+	for (int numRows : dbSizes) {
+		for (int numLabels : labelCounts) {
+			printf("db %d rows, %d labels\n", numRows, numLabels);
+			int numQueries = numRows <= 10000 ? 12 : (numRows <= 100000 ? 6 : 3);
+			verifyClassifiers(stats, rng, numRows, numLabels, numQueries, scaling);
+		}
+	}
+
+	// scaling curves
+	printf("\n%-22s %12s %7s %12s %14s %9s\n", "stage", "size", "labels", "new (ms)", "reference (ms)", "speedup");
+	for (const ScalingRow& row : scaling) {
+		printf("%-22s %12s %7d %12.3f %14.3f %8.1fx\n", row.stage.c_str(), row.size.c_str(), row.numLabels,
+			row.newMs, row.referenceMs, row.newMs > 0 ? row.referenceMs / row.newMs : 0.0);
+	}
+	if (!scalingFile.empty()) {
+		FILE* csv = fopen(scalingFile.c_str(), "w");
+		if (csv == NULL) {
+			printf("unable to write %s\n", scalingFile.c_str());
+		}
+		else {
+			fprintf(csv, "stage,size,labels,new_ms,reference_ms\n");
+			for (const ScalingRow& row : scaling) {
+				fprintf(csv, "%s,%s,%d,%.6f,%.6f\n", row.stage.c_str(), row.size.c_str(), row.numLabels, row.newMs, row.referenceMs);
+			}
+			fclose(csv);
+			printf("scaling curves written to %s\n", scalingFile.c_str());
+		}
+	}
+
+	printf("\n%d checks, %d failed\n", stats.checks, stats.failures);
+	return stats.failures;
+}
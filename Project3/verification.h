@@ -0,0 +1,35 @@
+/*
+ * Project 3 Real Time Object 2D Recognition
+ *
+ * Name:    verification.h
+ * Author:  Bryan Ang
+ * E-mail:  ang.b@northeastern.edu
+ * Date:    2026/10/19
+ * Purpose: This file contains the verification run. The optimized
+			segmentation, features and classifiers are run next to
+			the frozen reference copies (referenceImplementations.h)
+			on random images and dbs, their results compared, and
+			both timed for growing image and db sizes.
+ */
+
+#pragma once
+
+#include <string>
+
+// Compares the optimized paths with the reference copies:
+//	segmentFrame                 vs the original otsu / cv::dilate / cv::erode /
+//	                                regionGrowing / filterOnlylargestRegion pipeline
+//	labelRuns, findLargestRegion vs regionGrowing, filterOnlylargestRegion
+//	getFeatures                  vs the original getFeatures
+//	nearest / kNearestNeigbor    vs the original classifiers
+// and that differently named shared memory regions are separate.
+// Masks, region ids and labels must match exactly, features and
+// distances within a small relative tolerance.
+// Params:
+//	full:        images up to 3840x2160 and dbs up to 10M rows (needs
+//	             several GB of memory and minutes), otherwise up to
+//	             1920x1080 and 1M rows
+//	scalingFile: csv the timings are written to, empty for none
+//
+// Returns number of failed checks.
+int executeVerification(bool full, const std::string& scalingFile);